@@ -0,0 +1,124 @@
+#include "game.h"
+#include <chrono>
+#include <cstdlib>
+
+// ============================================================================
+// BENCH CATALOG : tirage des salles sur un catalogue synthétique
+// ============================================================================
+//
+// Usage : bench_catalog [--rooms N] [--picks N] [--legacy-picks N] [--seed S]
+//
+// Vérifie qu'aucune salle n'est tirée deux fois avant une remise à zéro, puis
+// compare le coût d'un tirage RoomCatalog à l'ancien algorithme (listes de
+// chaînes refiltrées par std::find à chaque tirage). Code de retour 1 en cas
+// de doublon.
+
+// Ancien Dungeon::pick_next_room_file, gardé ici comme référence
+static std::string	legacy_pick(const std::vector<std::string> pools[ROOM_CATEGORY_COUNT],
+						std::vector<std::string>& used, int rooms_visited) {
+	std::vector<std::string> avail[ROOM_CATEGORY_COUNT];
+	for (int cat = 0; cat < ROOM_CATEGORY_COUNT; ++cat) {
+		for (const auto& f : pools[cat]) {
+			if (std::find(used.begin(), used.end(), f) == used.end())
+				avail[cat].push_back(f);
+		}
+	}
+	float weights[ROOM_CATEGORY_COUNT];
+	weights[0] = avail[0].empty() ? 0.0f : std::max(1.0f, 50.0f - rooms_visited * 5.0f);
+	weights[1] = avail[1].empty() ? 0.0f : std::max(1.0f, 30.0f - rooms_visited * 2.0f);
+	weights[2] = avail[2].empty() ? 0.0f : 15.0f + rooms_visited * 3.0f;
+	weights[3] = avail[3].empty() ? 0.0f : 5.0f + rooms_visited * 4.0f;
+	float total = weights[0] + weights[1] + weights[2] + weights[3];
+	if (total <= 0.0f) {
+		used.clear();
+		return legacy_pick(pools, used, rooms_visited);
+	}
+	float roll = (float)random_int(0, 10000) / 10000.0f * total;
+	int chosen = 3;
+	float cumulative = 0.0f;
+	for (int i = 0; i < ROOM_CATEGORY_COUNT; ++i) {
+		cumulative += weights[i];
+		if (roll < cumulative) {
+			chosen = i;
+			break;
+		}
+	}
+	return avail[chosen][random_int(0, (int)avail[chosen].size() - 1)];
+}
+
+int main(int argc, char** argv) {
+	int rooms = 10000;
+	int picks = 1000000;
+	int legacy_picks = 200;
+	unsigned int seed = 42;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		std::string arg = argv[i];
+		if (arg == "--rooms") rooms = std::max(1, std::atoi(argv[i + 1]));
+		else if (arg == "--picks") picks = std::max(1, std::atoi(argv[i + 1]));
+		else if (arg == "--legacy-picks") legacy_picks = std::max(0, std::atoi(argv[i + 1]));
+		else if (arg == "--seed") seed = (unsigned int)std::strtoul(argv[i + 1], nullptr, 10);
+		else {
+			printf("ERROR: Unknown argument: %s\n", arg.c_str());
+			return 1;
+		}
+	}
+
+	// Répartition proche du jeu : beaucoup d'easy/medium, peu de boss
+	const int shares[ROOM_CATEGORY_COUNT] = {40, 30, 20, 10};
+	int share_total = 0;
+	for (int c = 0; c < ROOM_CATEGORY_COUNT; ++c)
+		share_total += shares[c];
+	RoomCatalog catalog;
+	std::vector<std::string> pools[ROOM_CATEGORY_COUNT];
+	for (int i = 0; i < rooms; ++i) {
+		int roll = i % share_total;
+		int category = 0;
+		while (roll >= shares[category]) {
+			roll -= shares[category];
+			category++;
+		}
+		std::string file = std::string(ROOM_PATH) + "/" + room_category_name(category)
+			+ "/synthetic_" + std::to_string(i) + ".roomb";
+		catalog.add(file, category);
+		pools[category].push_back(file);
+	}
+	printf("bench-catalog: rooms=%d (easy:%d medium:%d hard:%d boss:%d, shares %d/%d/%d/%d) seed=%u\n",
+		rooms, catalog.count(0), catalog.count(1), catalog.count(2), catalog.count(3),
+		shares[0], shares[1], shares[2], shares[3], seed);
+
+	typedef std::chrono::steady_clock Clock;
+	Rng rng(seed);
+	std::vector<int> seen_in_round(rooms, -1);
+	int per_category[ROOM_CATEGORY_COUNT] = {0, 0, 0, 0};
+	Clock::time_point start = Clock::now();
+	for (int p = 0; p < picks; ++p) {
+		int category = 0;
+		int id = catalog.pick(p % 50, rng, &category);
+		if (seen_in_round[id] == catalog._resets) {
+			printf("ERROR: room %d picked twice before a reset (pick %d)\n", id, p);
+			return 1;
+		}
+		seen_in_round[id] = catalog._resets;
+		catalog.mark_used(id);
+		per_category[category]++;
+	}
+	double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / picks;
+	printf("  catalog: %d picks, %.1f ns/pick, %d resets (easy:%d medium:%d hard:%d boss:%d)\n",
+		picks, ns, catalog._resets, per_category[0], per_category[1], per_category[2], per_category[3]);
+
+	if (legacy_picks > 0) {
+		random_seed(seed);
+		std::vector<std::string> used;
+		size_t checksum = 0;
+		start = Clock::now();
+		for (int p = 0; p < legacy_picks; ++p) {
+			std::string file = legacy_pick(pools, used, p % 50);
+			used.push_back(file);
+			checksum += file.size();
+		}
+		double legacy_ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / legacy_picks;
+		printf("  legacy:  %d picks, %.1f ns/pick (%.0fx slower, checksum %zu)\n",
+			legacy_picks, legacy_ns, legacy_ns / ns, checksum);
+	}
+	return 0;
+}
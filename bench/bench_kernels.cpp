@@ -0,0 +1,97 @@
+#include "game.h"
+#include <chrono>
+
+// ============================================================================
+// BENCH KERNELS : circle_overlaps scalaire vs SSE2 vs AVX2
+// ============================================================================
+//
+// Vérifie d'abord que chaque variante SIMD donne exactement les mêmes indices
+// que la version scalaire (tailles variées pour couvrir les restes de boucle),
+// puis mesure le débit. Code de retour 1 en cas de divergence.
+
+struct KernelVariant {
+	const char*		_name;
+	CircleOverlapFn	_fn;
+};
+
+static std::vector<KernelVariant>	available_variants() {
+	std::vector<KernelVariant> variants;
+	variants.push_back({"scalar", circle_overlaps_scalar});
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_cpu_init();
+	variants.push_back({"sse2", circle_overlaps_sse2});
+	if (__builtin_cpu_supports("avx2"))
+		variants.push_back({"avx2", circle_overlaps_avx2});
+#endif
+	return variants;
+}
+
+static void	fill_circles(size_t n, float extent, std::vector<float>& xs, std::vector<float>& ys, std::vector<float>& rs) {
+	xs.resize(n);
+	ys.resize(n);
+	rs.resize(n);
+	for (size_t i = 0; i < n; ++i) {
+		xs[i] = random_int(0, (int)extent * 100) / 100.0f;
+		ys[i] = random_int(0, (int)extent * 100) / 100.0f;
+		rs[i] = random_int(400, 3000) / 100.0f;
+	}
+}
+
+static bool	check_variants(const std::vector<KernelVariant>& variants) {
+	std::vector<float> xs, ys, rs;
+	std::vector<uint32_t> expected, got;
+	int checks = 0;
+	for (size_t n = 0; n <= 67; ++n) {
+		for (int round = 0; round < 50; ++round) {
+			fill_circles(n, 300.0f, xs, ys, rs);
+			float x = random_int(0, 30000) / 100.0f;
+			float y = random_int(0, 30000) / 100.0f;
+			float r = random_int(100, 8000) / 100.0f;
+			expected.assign(n + 1, 0);
+			size_t expected_count = circle_overlaps_scalar(x, y, r, xs.data(), ys.data(), rs.data(), n, expected.data());
+			for (size_t v = 1; v < variants.size(); ++v) {
+				got.assign(n + 1, 0);
+				size_t count = variants[v]._fn(x, y, r, xs.data(), ys.data(), rs.data(), n, got.data());
+				bool same = (count == expected_count)
+					&& std::equal(expected.begin(), expected.begin() + count, got.begin());
+				if (!same) {
+					printf("ERROR: %s differs from scalar (n=%zu, round=%d): %zu vs %zu hits\n",
+						variants[v]._name, n, round, count, expected_count);
+					return false;
+				}
+				++checks;
+			}
+		}
+	}
+	printf("  correctness: %d comparisons against scalar OK\n", checks);
+	return true;
+}
+
+int main() {
+	random_seed(1234);
+	std::vector<KernelVariant> variants = available_variants();
+	printf("bench-kernels: dispatch=%s\n", circle_overlaps_name());
+	if (!check_variants(variants))
+		return 1;
+
+	const size_t n = 1 << 16;
+	const int queries = 2000;
+	std::vector<float> xs, ys, rs;
+	fill_circles(n, 4000.0f, xs, ys, rs);
+	std::vector<uint32_t> out(n);
+	typedef std::chrono::steady_clock Clock;
+
+	for (const KernelVariant& v : variants) {
+		size_t hits = 0;
+		Clock::time_point start = Clock::now();
+		for (int q = 0; q < queries; ++q) {
+			float x = (float)(q * 37 % 4000);
+			float y = (float)(q * 91 % 4000);
+			hits += v._fn(x, y, 40.0f, xs.data(), ys.data(), rs.data(), n, out.data());
+		}
+		double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		printf("  %-7s %8.2f ms | %7.2f Mcircles/s | %zu hits\n",
+			v._name, ms, (double)n * queries / (ms * 1e3), hits);
+	}
+	return 0;
+}
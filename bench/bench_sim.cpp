@@ -0,0 +1,289 @@
+#include "game.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+// ============================================================================
+// BENCH SIM : Game::update en headless sur un scénario seedé
+// ============================================================================
+//
+// Usage : bench_sim [--room FILE] [--skeletons N] [--vampires N] [--priests N]
+//                   [--ticks N] [--warmup N] [--tick-rate N] [--threads N] [--seed S] [--bot] [--mortal]
+//                   [--waves] [--trace FILE]
+//
+// --waves : pas d'ennemis placés au départ, les vagues scriptées (WaveSpawner)
+// les font apparaître au fil de la simulation.
+// Les portes sont verrouillées (Game::_doors_locked) : le bot reste dans --room.
+// Avec --mortal, la mort du joueur arrête la mesure.
+// Si la salle change quand même, le bench échoue plutôt que d'afficher les
+// mesures d'une autre salle.
+// Compilé avec make PROFILE=1 : percentiles par zone du profiler, et --trace
+// écrit la trace Chrome (trace_event) des ticks mesurés.
+// Les allocations (operator new) faites pendant les ticks mesurés sont
+// comptées : un tick en régime établi ne doit pas en faire.
+
+// Compteur d'allocations : remplace l'operator new global de ce binaire
+// (new[] et les delete par défaut passent par ceux-ci). La version alignée
+// est celle qu'utilise std::pmr::new_delete_resource().
+// Seuls les threads qui exécutent les ticks sont comptés (le principal et les
+// workers du JobSystem) : le thread de préchargement des salles alloue en
+// parallèle, à un rythme qui dépend de l'ordonnanceur.
+static std::atomic<size_t>	g_allocations(0);
+static const int			MAX_COUNTED_THREADS = 64;
+static std::thread::id		g_counted_threads[MAX_COUNTED_THREADS];
+static std::atomic<int>		g_counted_thread_count(0);
+
+static void	count_allocation() {
+	int count = g_counted_thread_count.load(std::memory_order_acquire);
+	std::thread::id self = std::this_thread::get_id();
+	for (int i = 0; i < count; ++i) {
+		if (g_counted_threads[i] == self) {
+			g_allocations.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+	}
+}
+
+static void	count_thread(std::thread::id id) {
+	int count = g_counted_thread_count.load(std::memory_order_relaxed);
+	if (count >= MAX_COUNTED_THREADS)
+		return;
+	g_counted_threads[count] = id;
+	g_counted_thread_count.store(count + 1, std::memory_order_release);
+}
+
+void*	operator new(size_t size) {
+	count_allocation();
+	if (void* p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void*	operator new(size_t size, std::align_val_t alignment) {
+	count_allocation();
+	size_t align = (size_t)alignment;
+	if (void* p = std::aligned_alloc(align, (std::max(size, (size_t)1) + align - 1) / align * align))
+		return p;
+	throw std::bad_alloc();
+}
+
+void	operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void	operator delete(void* p, size_t) noexcept {
+	std::free(p);
+}
+
+void	operator delete(void* p, std::align_val_t) noexcept {
+	std::free(p);
+}
+
+void	operator delete(void* p, size_t, std::align_val_t) noexcept {
+	std::free(p);
+}
+
+struct BenchConfig {
+	std::string		_room;
+	int				_counts[3];			// skeletons, vampires, priests
+	int				_ticks;
+	int				_warmup;
+	int				_tick_rate;
+	int				_threads;
+	unsigned int	_seed;
+	bool			_bot;
+	bool			_mortal;
+	bool			_waves;
+	std::string		_trace;
+
+	BenchConfig()
+		:	_room(ROOM_PATH + "/boss/boss_00.room"),
+			_counts{100, 50, 25},
+			_ticks(5000),
+			_warmup(100),
+			_tick_rate(SIM_TICK_RATE),
+			_threads(0),
+			_seed(42),
+			_bot(false),
+			_mortal(false),
+			_waves(false) {}
+};
+
+static bool	parse_args(int argc, char** argv, BenchConfig& cfg) {
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		bool has_value = (i + 1 < argc);
+		if (arg == "--room" && has_value) cfg._room = argv[++i];
+		else if (arg == "--skeletons" && has_value) cfg._counts[0] = std::atoi(argv[++i]);
+		else if (arg == "--vampires" && has_value) cfg._counts[1] = std::atoi(argv[++i]);
+		else if (arg == "--priests" && has_value) cfg._counts[2] = std::atoi(argv[++i]);
+		else if (arg == "--ticks" && has_value) cfg._ticks = std::atoi(argv[++i]);
+		else if (arg == "--warmup" && has_value) cfg._warmup = std::atoi(argv[++i]);
+		else if (arg == "--tick-rate" && has_value) cfg._tick_rate = std::max(1, std::atoi(argv[++i]));
+		else if (arg == "--threads" && has_value) cfg._threads = std::max(0, std::atoi(argv[++i]));
+		else if (arg == "--seed" && has_value) cfg._seed = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+		else if (arg == "--bot") cfg._bot = true;
+		else if (arg == "--mortal") cfg._mortal = true;
+		else if (arg == "--waves") cfg._waves = true;
+		else if (arg == "--trace" && has_value) cfg._trace = argv[++i];
+		else {
+			printf("ERROR: Unknown or incomplete argument: %s\n", arg.c_str());
+			return false;
+		}
+	}
+	return cfg._ticks > 0;
+}
+
+// Position aléatoire atteignable depuis le spawn du joueur, assez dégagée pour le rayon
+static Vector2f	random_walkable_pos(const Room& room, float radius, Rng& rng) {
+	Vector2f pos;
+	if (room.random_spawn_point(radius, room.component_at(room.get_spawn()), rng, pos))
+		return pos;
+	return room.get_spawn();
+}
+
+static bool	setup_scenario(Game& game, const BenchConfig& cfg) {
+	game._rng.seed(cfg._seed);
+	if (game.init() != 0)
+		return false;
+	if (!game._dungeon.load_room(cfg._room))
+		return false;
+
+	const Room& room = game._dungeon.current_room();
+	game._player._pos = room.get_spawn();
+	// Le bot ne doit pas quitter la salle mesurée (et vider ses ennemis)
+	game._doors_locked = true;
+	game._spawner._enabled = cfg._waves;
+	if (cfg._waves) {
+		game.change_state(GameState::RUNNING);
+		return true;
+	}
+	const Entity::Type types[3] = {Entity::SKELETON, Entity::VAMPIRE, Entity::PRIEST};
+	for (int t = 0; t < 3; ++t) {
+		for (int i = 0; i < cfg._counts[t]; ++i) {
+			Entity probe(types[t]);
+			game.spawn_enemy(types[t], random_walkable_pos(room, probe._radius, game._rng));
+		}
+	}
+	game.change_state(GameState::RUNNING);
+	return true;
+}
+
+static double	percentile(const std::vector<double>& sorted, double p) {
+	if (sorted.empty())
+		return 0;
+	size_t idx = (size_t)(p * (sorted.size() - 1) + 0.5);
+	return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+int main(int argc, char** argv) {
+	BenchConfig cfg;
+	if (!parse_args(argc, argv, cfg))
+		return 1;
+
+	Game game;
+	game._tick_rate = cfg._tick_rate;
+	game.set_thread_count(cfg._threads);
+	if (!setup_scenario(game, cfg)) {
+		printf("ERROR: Failed to set up scenario (room: %s)\n", cfg._room.c_str());
+		return 1;
+	}
+
+	count_thread(std::this_thread::get_id());
+	for (const std::thread& worker : game._jobs._threads)
+		count_thread(worker.get_id());
+
+	ScriptedInput idle;
+	BotInput bot;
+	InputSource* source = cfg._bot ? (InputSource*)&bot : (InputSource*)&idle;
+	InputState input;
+	size_t spawned = game._enemies.size();
+	int rooms_visited = game._dungeon._rooms_visited;
+
+	std::vector<double> samples;
+	samples.reserve(cfg._ticks);
+	typedef std::chrono::steady_clock Clock;
+	size_t allocations = 0;
+	int allocating_ticks = 0;
+	int death_tick = -1;
+
+	for (int tick = 0; tick < cfg._warmup + cfg._ticks; ++tick) {
+		// Hors mesure : le joueur reste en vie pour que chaque tick simule vraiment
+		if (!cfg._mortal)
+			game._player._hp = game._player._max_hp;
+		source->poll(game, input);
+
+		size_t allocations_before = g_allocations.load(std::memory_order_relaxed);
+		Clock::time_point start = Clock::now();
+		game.tick(input);
+		Clock::time_point end = Clock::now();
+		size_t tick_allocations = g_allocations.load(std::memory_order_relaxed) - allocations_before;
+
+		if (tick >= cfg._warmup) {
+			samples.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+			allocations += tick_allocations;
+			allocating_ticks += (tick_allocations > 0);
+		}
+		else if (tick == cfg._warmup - 1)
+			profiler().clear();
+
+		// --mortal : la mort du joueur termine le scénario (le restart du bot
+		// relancerait une partie dans une autre salle)
+		if (game._state == GameState::GAME_OVER) {
+			death_tick = tick;
+			break;
+		}
+	}
+
+	// Garde-fou : des mesures prises dans une autre salle ne décrivent pas le scénario
+	if (game._dungeon._rooms_visited != rooms_visited) {
+		printf("ERROR: Left the scenario room during the bench (%s), results discarded\n", cfg._room.c_str());
+		return 1;
+	}
+	if (samples.empty()) {
+		printf("ERROR: Player died during warmup (tick %d), nothing measured\n", death_tick);
+		return 1;
+	}
+
+	double total_us = 0;
+	for (double s : samples)
+		total_us += s;
+	std::sort(samples.begin(), samples.end());
+
+	if (cfg._waves)
+		printf("bench-sim: room=%s seed=%u waves input=%s threads=%d\n",
+			cfg._room.c_str(), cfg._seed, cfg._bot ? "bot" : "idle", cfg._threads);
+	else
+		printf("bench-sim: room=%s seed=%u skeletons=%d vampires=%d priests=%d input=%s threads=%d\n",
+			cfg._room.c_str(), cfg._seed, cfg._counts[0], cfg._counts[1], cfg._counts[2],
+			cfg._bot ? "bot" : "idle", cfg._threads);
+	printf("  ticks:       %zu (warmup %d, sim %d Hz)", samples.size(), cfg._warmup, cfg._tick_rate);
+	if (death_tick >= 0)
+		printf(", player died at tick %d", death_tick);
+	printf("\n");
+	printf("  enemies:     %zu spawned, %zu alive at end, %zu projectiles\n",
+		spawned, game._enemies.size(), game._projectiles.size());
+	if (cfg._waves)
+		printf("  waves:       reached %d, %d enemies spawned\n", game._spawner._wave + 1, game._spawner._spawned);
+	printf("  projectiles: pool %zu/%zu, high-water %zu, exhausted %zu\n",
+		game._projectiles.size(), game._projectiles._capacity,
+		game._projectiles._high_water, game._projectiles._exhausted);
+	printf("  allocations: %zu in %d of %d ticks, frame arena high-water %zu/%zu bytes, %zu overflows\n",
+		allocations, allocating_ticks, cfg._ticks, game._frame_arena._high_water, game._frame_arena._capacity,
+		game._frame_arena._overflows);
+	printf("  ticks/sec:   %.0f\n", total_us > 0 ? samples.size() / (total_us * 1e-6) : 0.0);
+	printf("  tick (us):   mean %.2f | p50 %.2f | p90 %.2f | p99 %.2f | max %.2f\n",
+		total_us / samples.size(), percentile(samples, 0.50), percentile(samples, 0.90),
+		percentile(samples, 0.99), samples.back());
+#ifdef CFV_PROFILE
+	std::vector<ProfileZoneStats> zones;
+	profiler().zone_stats(zones);
+	printf("  zones (us):  %-18s %8s %8s %8s %8s\n", "", "count", "p50", "p95", "p99");
+	for (const ProfileZoneStats& z : zones)
+		printf("               %-18s %8zu %8.2f %8.2f %8.2f\n", z._name, z._count, z._p50, z._p95, z._p99);
+#endif
+	if (!cfg._trace.empty() && !profiler().dump_chrome_trace(cfg._trace))
+		return 1;
+	return 0;
+}
@@ -0,0 +1,114 @@
+#include "game.h"
+#include <chrono>
+#include <cstdlib>
+
+// ============================================================================
+// BENCH SNAPSHOT : aller-retour instantané / restauration de Game
+// ============================================================================
+//
+// Usage : bench_snapshot [--room FILE] [--enemies N] [--warmup N] [--ticks N]
+//                        [--iterations N] [--seed S]
+//
+// Après --warmup ticks joués par le bot, prend un instantané A, simule --ticks
+// ticks (instantané B), restaure A et rejoue les mêmes inputs. Vérifie que les
+// checksums et les octets des instantanés retombent sur A puis B, puis mesure
+// le coût d'un save et d'un restore. Code de retour 1 en cas d'écart.
+
+static void	run_ticks(Game& game, InputSource& source, int ticks, std::vector<InputState>* inputs) {
+	InputState input;
+	for (int t = 0; t < ticks; ++t) {
+		game._player._hp = game._player._max_hp;
+		if (inputs && t < (int)inputs->size())
+			input = (*inputs)[t];
+		else
+			source.poll(game, input);
+		if (inputs && t >= (int)inputs->size())
+			inputs->push_back(input);
+		game.tick(input);
+	}
+}
+
+static bool	same_bytes(const Snapshot& a, const Snapshot& b) {
+	return a._size == b._size && std::memcmp(a._buffer.data(), b._buffer.data(), a._size) == 0;
+}
+
+int main(int argc, char** argv) {
+	std::string room = ROOM_PATH + "/boss/boss_00.room";
+	int enemies = 500;
+	int warmup = 300;
+	int ticks = 600;
+	int iterations = 2000;
+	unsigned int seed = 42;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		std::string arg = argv[i];
+		if (arg == "--room") room = argv[i + 1];
+		else if (arg == "--enemies") enemies = std::max(0, std::atoi(argv[i + 1]));
+		else if (arg == "--warmup") warmup = std::max(0, std::atoi(argv[i + 1]));
+		else if (arg == "--ticks") ticks = std::max(1, std::atoi(argv[i + 1]));
+		else if (arg == "--iterations") iterations = std::max(1, std::atoi(argv[i + 1]));
+		else if (arg == "--seed") seed = (unsigned int)std::strtoul(argv[i + 1], nullptr, 10);
+		else {
+			printf("ERROR: Unknown argument: %s\n", arg.c_str());
+			return 1;
+		}
+	}
+
+	Game game;
+	game._rng.seed(seed);
+	if (game.init() != 0 || !game._dungeon.load_room(room)) {
+		printf("ERROR: Failed to set up scenario (room: %s)\n", room.c_str());
+		return 1;
+	}
+	// Mélange proche de bench_sim (4:2:1), vagues actives par-dessus
+	const Room& current = game._dungeon.current_room();
+	game._player._pos = current.get_spawn();
+	const Entity::Type types[3] = {Entity::SKELETON, Entity::VAMPIRE, Entity::PRIEST};
+	for (int i = 0; i < enemies; ++i) {
+		Entity::Type type = types[i % 7 < 4 ? 0 : i % 7 < 6 ? 1 : 2];
+		Vector2f pos = current.get_spawn();
+		current.random_spawn_point(Entity(type)._radius, current.component_at(pos), game._rng, pos);
+		game.spawn_enemy(type, pos);
+	}
+	game.change_state(GameState::RUNNING);
+
+	BotInput bot;
+	run_ticks(game, bot, warmup, nullptr);
+
+	Snapshot a, b, check;
+	game.save_snapshot(a);
+	uint64_t checksum_a = game.checksum();
+	size_t entities = game._enemies.size();
+	std::vector<InputState> inputs;
+	run_ticks(game, bot, ticks, &inputs);
+	game.save_snapshot(b);
+	uint64_t checksum_b = game.checksum();
+
+	printf("bench-snapshot: room=%s seed=%u enemies=%zu projectiles=%zu\n",
+		room.c_str(), seed, entities, game._projectiles.size());
+
+	// Retour en A puis resimulation des mêmes inputs : doit retomber sur B
+	bool ok = game.restore_snapshot(a);
+	game.save_snapshot(check);
+	ok = ok && game.checksum() == checksum_a && same_bytes(a, check);
+	run_ticks(game, bot, ticks, &inputs);
+	game.save_snapshot(check);
+	bool resim_ok = game.checksum() == checksum_b && same_bytes(b, check);
+	printf("  round trip:  restore %s, resimulate %d ticks %s (checksum %016llx)\n",
+		ok ? "OK" : "MISMATCH", ticks, resim_ok ? "OK" : "MISMATCH", (unsigned long long)checksum_b);
+	if (!ok || !resim_ok)
+		return 1;
+
+	typedef std::chrono::steady_clock Clock;
+	game.restore_snapshot(a);
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < iterations; ++i)
+		game.save_snapshot(check);
+	double save_us = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / iterations;
+	start = Clock::now();
+	for (int i = 0; i < iterations; ++i)
+		game.restore_snapshot(a);
+	double restore_us = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / iterations;
+	printf("  snapshot:    %.1f KB, save %.2f us, restore %.2f us (%d iterations)\n",
+		a._size / 1024.0, save_us, restore_us, iterations);
+	return 0;
+}
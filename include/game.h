@@ -9,6 +9,17 @@
 #include <fstream>
 #include <sstream>
 #include <random>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <unordered_map>
+#include <chrono>
+#include <cstring>
+#include <type_traits>
+#include <memory_resource>
 
 // ============================================================================
 // CONSTANTS & ENUMS
@@ -33,22 +44,238 @@ const int REFERENCE_TILE_SIZE = 64;
 const int SCREEN_WIDTH = 1920;
 const int SCREEN_HEIGHT = 1020;
 const int TARGET_FPS = 60;
+const int SIM_TICK_RATE = 60;			// Ticks de simulation par seconde (pas fixe)
+const int MAX_CATCHUP_STEPS = 5;		// Ticks max rattrapés par frame après un hitch
+const size_t ENEMY_UPDATE_GRAIN = 128;	// Ennemis par job dans l'update parallèle
+const size_t PROJECTILE_POOL_CAPACITY = 4096;	// Projectiles vivants max (pool fixe)
+const int MAX_TILE_LAYER_SIZE = 4096;	// Côté max (px) de la couche de tuiles cuite
+const float VIEW_CULL_MARGIN = 32.0f;	// Marge (px) du culling : barres de vie, interpolation
+const float SPRITE_ANIMATION_FPS = 8.0f;	// Frames par seconde des animations de l'atlas
+const size_t FRAME_ARENA_SIZE = 256 * 1024;	// Allocations transitoires d'un tick
+const size_t ROOM_ARENA_SIZE = 1024 * 1024;	// Brouillon du chargement d'une salle
 
 const std::string ROOM_PATH = "rooms";
+const std::string ARCHETYPE_FILE = "data/archetypes.txt";	// Surcharges optionnelles des archétypes
+const std::string ATLAS_FILE = "data/sprites.atlas";		// Index de l'atlas (make atlas), optionnel
+const float WAVE_PAUSE = 3.0f;			// Pause (s) avant la vague suivante si la salle est vide
+const float WAVE_INTERVAL = 20.0f;		// Sinon, délai (s) après la dernière apparition de la vague
 
 // ============================================================================
 // FORWARD DECLARATIONS
 // ============================================================================
 
 struct Vector2f;
+struct InputState;
+struct InputSource;
+struct InputRecorder;
+struct Snapshot;
 struct Weapon;
 struct Projectile;
+struct ProjectilePool;
 struct Player;
 struct Entity;
+struct EntityStore;
 struct Room;
+struct RoomTemplate;
+struct RoomAnalysis;
+struct SpatialGrid;
+struct FlowField;
 struct Dungeon;
+struct WaveSpawner;
 struct Game;
 
+// ============================================================================
+// COLLISION KERNELS
+// ============================================================================
+
+// Un cercle contre n cercles packés, sans sqrt. Écrit les indices en collision
+// dans out (capacité n) et renvoie leur nombre. SSE2/AVX2 choisis au runtime.
+typedef size_t	(*CircleOverlapFn)(float x, float y, float r, const float* xs, const float* ys,
+					const float* rs, size_t n, uint32_t* out);
+
+const size_t	OVERLAP_BATCH = 64;		// Taille des lots sur la pile pour les appelants
+
+size_t			circle_overlaps(float x, float y, float r, const float* xs, const float* ys,
+					const float* rs, size_t n, uint32_t* out);
+size_t			circle_overlaps_scalar(float x, float y, float r, const float* xs, const float* ys,
+					const float* rs, size_t n, uint32_t* out);
+#if defined(__x86_64__) || defined(__i386__)
+size_t			circle_overlaps_sse2(float x, float y, float r, const float* xs, const float* ys,
+					const float* rs, size_t n, uint32_t* out);
+size_t			circle_overlaps_avx2(float x, float y, float r, const float* xs, const float* ys,
+					const float* rs, size_t n, uint32_t* out);
+#endif
+CircleOverlapFn	circle_overlaps_impl();
+const char*		circle_overlaps_name();
+
+// ============================================================================
+// JOB SYSTEM
+// ============================================================================
+
+// Pool de threads à vol de tâches : chaque worker a sa file (LIFO pour lui,
+// volée par le haut par les autres). Le thread appelant est le worker 0 et
+// participe au travail ; parallel_for ne rend la main qu'une fois tout exécuté.
+struct JobSystem {
+	struct Job {
+		void	(*_fn)(void* ctx, size_t begin, size_t end, int worker);
+		void*	_ctx;
+		size_t	_begin;
+		size_t	_end;
+	};
+
+	// File d'un worker : anneau de capacité fixe (pas d'allocation après init)
+	struct Queue {
+		std::mutex			_lock;
+		std::vector<Job>	_jobs;
+		size_t				_head;		// Prochain job à voler
+		size_t				_tail;		// Prochain slot libre
+
+		Queue() : _head(0), _tail(0) {}
+	};
+
+	std::vector<std::thread>				_threads;
+	std::vector<std::unique_ptr<Queue>>		_queues;
+	std::atomic<int>						_pending;	// Jobs pas encore terminés
+	std::mutex								_wake_lock;
+	std::condition_variable					_wake;
+	uint64_t								_batch;		// Incrémenté à chaque parallel_for
+	bool									_stop;
+
+	static const size_t	QUEUE_CAPACITY = 1024;
+
+	JobSystem();
+	~JobSystem();
+	JobSystem(const JobSystem&) = delete;
+	JobSystem&	operator=(const JobSystem&) = delete;
+
+	void		init(int thread_count);
+	void		shutdown();
+	int			worker_count() const { return (int)_queues.size(); }
+	static int	default_thread_count();
+
+	// Découpe [begin, end) en morceaux de `grain` et appelle fn(begin, end, worker)
+	template <typename Fn>
+	void		parallel_for(size_t begin, size_t end, size_t grain, Fn& fn) {
+		run(begin, end, grain, &JobSystem::trampoline<Fn>, &fn);
+	}
+
+	template <typename Fn>
+	static void	trampoline(void* ctx, size_t begin, size_t end, int worker) {
+		(*static_cast<Fn*>(ctx))(begin, end, worker);
+	}
+
+	void		run(size_t begin, size_t end, size_t grain,
+					void (*fn)(void*, size_t, size_t, int), void* ctx);
+	bool		pop(int worker, Job& out);
+	bool		steal(int thief, Job& out);
+	void		execute(const Job& job, int worker);
+	void		worker_loop(int worker);
+};
+
+// ============================================================================
+// PROFILER
+// ============================================================================
+
+// Zones chronométrées : PROFILE_ZONE("nom") mesure la fin du bloc courant.
+// Compilé seulement avec -DCFV_PROFILE (make PROFILE=1), sinon aucun coût.
+// Le nom doit être une chaîne littérale (seul le pointeur est stocké).
+#ifdef CFV_PROFILE
+# define PROFILE_CONCAT_(a, b)	a##b
+# define PROFILE_CONCAT(a, b)	PROFILE_CONCAT_(a, b)
+# define PROFILE_ZONE(name)		ProfileScope PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+#else
+# define PROFILE_ZONE(name)		do {} while (0)
+#endif
+
+struct ProfileEvent {
+	const char*	_name;
+	uint64_t	_start;				// ns depuis l'origine du profiler
+	uint64_t	_end;
+};
+
+// Anneau d'un thread : un seul écrivain (son thread), sans verrou. Les plus
+// anciens événements sont écrasés. À lire entre deux ticks (workers au repos).
+struct ProfileRing {
+	static const size_t			CAPACITY = 1 << 15;		// Puissance de 2
+
+	std::vector<ProfileEvent>	_events;
+	std::atomic<uint64_t>		_written;				// Événements écrits depuis le début
+	int							_thread;
+
+	ProfileRing(int thread) : _events(CAPACITY), _written(0), _thread(thread) {}
+	void		push(const ProfileEvent& e) {
+		uint64_t n = _written.load(std::memory_order_relaxed);
+		_events[n & (CAPACITY - 1)] = e;
+		_written.store(n + 1, std::memory_order_release);
+	}
+};
+
+// Percentiles d'une zone (µs) sur les événements encore dans les anneaux
+struct ProfileZoneStats {
+	const char*	_name;
+	size_t		_count;
+	double		_p50;
+	double		_p95;
+	double		_p99;
+};
+
+// Registre des anneaux (un par thread, créé à son premier événement)
+struct Profiler {
+	std::mutex									_lock;			// Seulement pour l'enregistrement
+	std::vector<std::unique_ptr<ProfileRing>>	_rings;
+	std::chrono::steady_clock::time_point		_origin;
+	std::vector<ProfileZoneStats>				_overlay_stats;	// Cache de l'overlay
+	int											_overlay_age;
+
+	Profiler();
+	uint64_t	now() const;
+	ProfileRing&	ring();
+	void		record(const char* name, uint64_t start, uint64_t end) { ring().push({name, start, end}); }
+	void		clear();
+	void		zone_stats(std::vector<ProfileZoneStats>& out) const;
+	bool		dump_chrome_trace(const std::string& file) const;
+	void		draw_overlay(int x, int y);
+};
+
+Profiler&	profiler();
+
+struct ProfileScope {
+	const char*	_name;
+	uint64_t	_start;
+
+	ProfileScope(const char* name) : _name(name), _start(profiler().now()) {}
+	~ProfileScope() { profiler().record(_name, _start, profiler().now()); }
+};
+
+// ============================================================================
+// ARENAS
+// ============================================================================
+
+// Arène à pointeur croissant, utilisable par les conteneurs std::pmr : un bloc
+// alloué une fois, chaque allocation avance un curseur, deallocate ne fait
+// rien et reset() libère tout d'un coup. Quand le bloc est plein, la suite
+// vient du tas (comptée dans _overflows) jusqu'au prochain reset : le bloc est
+// trop petit. Aucun conteneur alloué dedans ne doit survivre au reset.
+// Un seul thread à la fois.
+struct Arena : std::pmr::memory_resource {
+	std::unique_ptr<uint8_t[]>			_block;
+	size_t								_capacity;
+	size_t								_offset;		// Octets du bloc servis depuis le reset
+	size_t								_high_water;	// Plus grand _offset atteint
+	size_t								_overflows;		// Allocations servies par le tas (cumul)
+	std::pmr::monotonic_buffer_resource	_overflow;
+
+	explicit Arena(size_t capacity);
+	Arena(const Arena&) = delete;
+	Arena&	operator=(const Arena&) = delete;
+	void	reset();
+
+protected:
+	void*	do_allocate(size_t bytes, size_t alignment) override;
+	void	do_deallocate(void*, size_t, size_t) override {}
+	bool	do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
 // ============================================================================
 // STRUCTS
 // ============================================================================
@@ -91,6 +318,247 @@ struct Vector2f {
 	}
 };
 
+// Parcourt dans l'ordre les cellules unité traversées par le segment [a, b]
+// (coordonnées déjà en cellules), DDA d'Amanatides & Woo. Appelle fn(cx, cy, t)
+// avec t ∈ [0, 1] la fraction du segment à l'entrée de la cellule ; fn renvoie
+// false pour arrêter. Coût proportionnel au nombre de cellules traversées.
+template <typename Fn>
+void	grid_traverse(const Vector2f& a, const Vector2f& b, Fn fn) {
+	int cx = (int)std::floor(a._x);
+	int cy = (int)std::floor(a._y);
+	int steps = std::abs((int)std::floor(b._x) - cx) + std::abs((int)std::floor(b._y) - cy);
+	float dx = b._x - a._x;
+	float dy = b._y - a._y;
+	int step_x = (dx > 0) ? 1 : -1;
+	int step_y = (dy > 0) ? 1 : -1;
+	// t pour traverser une cellule entière, et t de la prochaine frontière
+	float delta_x = (dx != 0) ? std::fabs(1.0f / dx) : INFINITY;
+	float delta_y = (dy != 0) ? std::fabs(1.0f / dy) : INFINITY;
+	float next_x = (dx > 0) ? (cx + 1 - a._x) * delta_x : (dx < 0) ? (a._x - cx) * delta_x : INFINITY;
+	float next_y = (dy > 0) ? (cy + 1 - a._y) * delta_y : (dy < 0) ? (a._y - cy) * delta_y : INFINITY;
+	float t = 0;
+	for (int i = 0; fn(cx, cy, t) && i < steps; ++i) {
+		if (next_x < next_y) {
+			t = next_x;
+			next_x += delta_x;
+			cx += step_x;
+		} else {
+			t = next_y;
+			next_y += delta_y;
+			cy += step_y;
+		}
+	}
+}
+
+// Générateur seedable de la simulation. Tout le hasard d'une partie (salles,
+// vagues, points de spawn) vient du Rng de Game : même graine et mêmes inputs
+// donnent la même partie.
+struct Rng {
+	std::mt19937	_engine;
+	uint32_t		_seed;
+
+	explicit Rng(uint32_t seed = 0) : _engine(seed), _seed(seed) {}
+	void		seed(uint32_t seed) { _seed = seed; _engine.seed(seed); }
+	int			range(int min, int max) { return std::uniform_int_distribution<int>(min, max)(_engine); }
+};
+
+// Instantané de la simulation : sections trivialement copiables écrites à la
+// suite dans un tampon réutilisé (aucune allocation une fois la capacité
+// atteinte). Un tableau est écrit comme sa taille puis ses éléments. La
+// lecture se fait dans le même ordre ; une lecture hors du tampon passe _ok
+// à false et laisse la valeur intacte.
+const char		SNAPSHOT_MAGIC[4] = {'C', 'F', 'V', 'S'};
+const uint16_t	SNAPSHOT_VERSION = 1;
+const size_t	SNAPSHOT_INITIAL_CAPACITY = 256 * 1024;
+
+struct Snapshot {
+	std::vector<uint8_t>	_buffer;
+	size_t					_size;				// Octets écrits
+	size_t					_read;				// Curseur de lecture
+	bool					_ok;				// Aucune lecture hors du tampon
+
+	Snapshot(size_t capacity = SNAPSHOT_INITIAL_CAPACITY) : _buffer(capacity), _size(0), _read(0), _ok(true) {}
+	void		clear() { _size = 0; _read = 0; _ok = true; }
+	void		rewind() { _read = 0; _ok = true; }
+
+	void		write_bytes(const void* data, size_t size) {
+		if (_size + size > _buffer.size())
+			_buffer.resize(std::max(_size + size, _buffer.size() * 2));
+		if (size)
+			std::memcpy(_buffer.data() + _size, data, size);
+		_size += size;
+	}
+	bool		read_bytes(void* data, size_t size) {
+		if (!_ok || _read + size > _size)
+			return _ok = false;
+		if (size)
+			std::memcpy(data, _buffer.data() + _read, size);
+		_read += size;
+		return true;
+	}
+
+	template <typename T>
+	void		write(const T& value) {
+		static_assert(std::is_trivially_copyable<T>::value, "section non trivialement copiable");
+		write_bytes(&value, sizeof(T));
+	}
+	template <typename T>
+	void		write_array(const std::vector<T>& values) {
+		static_assert(std::is_trivially_copyable<T>::value, "section non trivialement copiable");
+		write((uint64_t)values.size());
+		write_bytes(values.data(), values.size() * sizeof(T));
+	}
+	void		write_string(const std::string& text) {
+		write((uint64_t)text.size());
+		write_bytes(text.data(), text.size());
+	}
+
+	template <typename T>
+	bool		read(T& value) {
+		static_assert(std::is_trivially_copyable<T>::value, "section non trivialement copiable");
+		return read_bytes(&value, sizeof(T));
+	}
+	template <typename T>
+	bool		read_array(std::vector<T>& values) {
+		static_assert(std::is_trivially_copyable<T>::value, "section non trivialement copiable");
+		uint64_t count = 0;
+		if (!read(count) || count > (_size - _read) / sizeof(T))
+			return _ok = false;
+		values.resize(count);
+		return read_bytes(values.data(), count * sizeof(T));
+	}
+	bool		read_string(std::string& text) {
+		uint64_t count = 0;
+		if (!read(count) || count > _size - _read)
+			return _ok = false;
+		text.resize(count);
+		return read_bytes(&text[0], count);
+	}
+};
+
+// ============================================================================
+// INPUT
+// ============================================================================
+
+// Commandes d'un tick : ce qui est maintenu (déplacement, visée) et les appuis
+// ponctuels (edges) qui ne doivent être traités qu'une seule fois.
+struct InputState {
+	Vector2f	_move;				// Direction de déplacement brute (non normalisée)
+	Vector2f	_aim;				// Point visé en coordonnées monde (souris)
+	bool		_dash;				// SPACE/SHIFT : démarre depuis le menu, dash en jeu
+	bool		_attack;			// Clic gauche
+	bool		_weapon_1;
+	bool		_weapon_2;
+	bool		_switch_weapon;
+	bool		_restart;
+
+	InputState();
+	void		clear_edges();
+	void		merge(const InputState& frame);
+};
+
+// Source d'input : clavier/souris raylib, script, bot... Game ne poll jamais
+// raylib directement, ce qui permet de faire tourner la simulation sans fenêtre.
+struct InputSource {
+	virtual			~InputSource() {}
+	virtual void	poll(const Game& game, InputState& out) = 0;
+};
+
+struct RaylibInput : InputSource {
+	void	poll(const Game& game, InputState& out) override;
+};
+
+struct ScriptedInput : InputSource {
+	struct Step {
+		int			_ticks;			// Nombre de ticks pendant lesquels l'input est rejoué
+		InputState	_input;
+	};
+
+	std::vector<Step>	_steps;
+	size_t				_cursor;
+	int					_elapsed;
+	bool				_loop;
+
+	ScriptedInput(bool loop = true);
+	void	push(int ticks, const InputState& input);
+	void	poll(const Game& game, InputState& out) override;
+};
+
+struct BotInput : InputSource {
+	float	_keep_distance;			// Distance que le bot garde avec l'ennemi le plus proche
+	int		_tick;
+
+	BotInput(float keep_distance = 150.0f);
+	void	poll(const Game& game, InputState& out) override;
+};
+
+// ============================================================================
+// REPLAY
+// ============================================================================
+
+// Enregistrement d'une partie (.cfvi) : en-tête fixe, puis par tick un octet de
+// drapeaux (edges, et quels vecteurs ont changé) suivi des seuls vecteurs
+// modifiés depuis le tick précédent. Après chaque _checksum_interval-ième
+// tick, un uint64 : Game::checksum() à ce moment. Little-endian.
+const char		REPLAY_MAGIC[4] = {'C', 'F', 'V', 'I'};
+const uint16_t	REPLAY_VERSION = 1;
+const int		REPLAY_CHECKSUM_INTERVAL = 60;	// Ticks entre deux checksums d'état
+
+struct ReplayHeader {
+	char		_magic[4];
+	uint16_t	_version;
+	uint16_t	_tick_rate;
+	uint32_t	_seed;				// Graine du Rng de Game avant init()
+	uint32_t	_checksum_interval;
+};
+static_assert(sizeof(ReplayHeader) == 16, "ReplayHeader doit rester packé");
+
+enum ReplayFlag : uint8_t {
+	REPLAY_DASH = 1 << 0,
+	REPLAY_ATTACK = 1 << 1,
+	REPLAY_WEAPON_1 = 1 << 2,
+	REPLAY_WEAPON_2 = 1 << 3,
+	REPLAY_SWITCH_WEAPON = 1 << 4,
+	REPLAY_RESTART = 1 << 5,
+	REPLAY_MOVE = 1 << 6,			// _move suit (2 floats)
+	REPLAY_AIM = 1 << 7				// _aim suit (2 floats)
+};
+
+// Écrit l'input de chaque tick passé à Game::tick (branché via Game::_recorder)
+struct InputRecorder {
+	std::ofstream	_out;
+	std::string		_file;
+	InputState		_last;				// Input du tick précédent (base des deltas)
+	uint32_t		_ticks;
+	uint32_t		_checksum_interval;
+
+	InputRecorder();
+	bool	open(const std::string& file, const Game& game, int checksum_interval = REPLAY_CHECKSUM_INTERVAL);
+	void	record(const InputState& input, const Game& game);
+	void	close();
+};
+
+// Rejoue un enregistrement tick par tick. Avant chaque input, compare le
+// checksum attendu (s'il y en a un) à l'état courant de la partie.
+struct ReplayInput : InputSource {
+	std::vector<uint8_t>	_data;
+	size_t					_cursor;
+	ReplayHeader			_header;
+	InputState				_last;
+	uint32_t				_ticks;				// Inputs déjà rendus
+	bool					_pending;			// _expected reste à vérifier
+	uint64_t				_expected;
+	int						_checked;			// Checksums vérifiés
+	int						_divergences;
+	int64_t					_first_divergence;	// Tick de la première divergence (-1 = aucune)
+
+	ReplayInput();
+	bool	load(const std::string& file);
+	bool	done() const { return _cursor >= _data.size(); }
+	void	poll(const Game& game, InputState& out) override;
+	void	verify(const Game& game);
+};
+
 struct Weapon {
 	enum Type {
 		SWORD,
@@ -108,6 +576,7 @@ struct Weapon {
 
 struct Projectile {
 	Vector2f	_pos;
+	Vector2f	_prev_pos;		// Position au tick précédent (interpolation du rendu)
 	Vector2f	_vel;
 	float		_damage;
 	float		_radius;
@@ -115,9 +584,10 @@ struct Projectile {
 	bool		_alive;
 	bool		_from_player;
 	
+	Projectile();
 	Projectile(const Vector2f& pos, const Vector2f& vel, float damage, float radius, bool from_player, float lifetime = 3.0f);
 	void		update(float dt, const Room& room);
-	void		draw() const;
+	void		draw(float alpha) const;
 };
 
 struct Player {
@@ -128,6 +598,7 @@ struct Player {
 	bool					_is_attacking;		// Animation d'attaque en cours
 	float					_attack_anim_timer;	// Timer animation attaque
 	Vector2f				_pos;
+	Vector2f				_prev_pos;			// Position au tick précédent (interpolation du rendu)
 	Vector2f				_vel;
 	Vector2f				_acc;
 	float					_speed;
@@ -141,9 +612,10 @@ struct Player {
 		
 	Player();
 	void		reset();
-	void		update(float dt);
-	void		draw() const;
-	void		attack(std::vector<Entity>& enemies, std::vector<Projectile>& projectiles);
+	void		update(float dt, const InputState& input);
+	void		draw(float alpha) const;
+	void		draw_hud() const;
+	void		attack(EntityStore& enemies, const SpatialGrid& grid, ProjectilePool& projectiles);
 	void		switch_weapon();
 };
 
@@ -155,7 +627,7 @@ struct Entity {
 		UNKNOWN
 	};
 
-	Type					_type;
+	uint8_t					_archetype;			// Indice dans archetypes() (= Entity::Type)
 	Vector2f				_pos;
 	Vector2f				_vel;
 	float					_radius;
@@ -168,8 +640,277 @@ struct Entity {
 	float					_shoot_cooldown;	// Intervalle entre tirs
 		
 	Entity(Type t = UNKNOWN, const Vector2f& p = Vector2f(0, 0));
-	void		update(float dt, const Player& player, const Room& room, std::vector<Projectile>& projectiles);
-	void		draw() const;
+};
+
+const int ENTITY_ARCHETYPE_COUNT = Entity::UNKNOWN + 1;
+const int WEAPON_ARCHETYPE_COUNT = Weapon::STAFF + 1;
+
+// Statistiques d'un type d'ennemi, indexées par Entity::Type
+struct EntityArchetype {
+	const char*	_name;				// Clé dans ARCHETYPE_FILE
+	Color		_color;
+	float		_radius;
+	float		_hp;
+	float		_speed;
+	float		_dammage;
+	float		_shoot_cooldown;		// Intervalle entre tirs (0 = ne tire pas)
+	float		_shot_speed;
+	float		_shot_radius;
+	float		_shot_damage_scale;		// Dégâts du tir = _dammage * scale
+	float		_shot_lifetime;
+	const char*	_sprite;				// Animation dans l'atlas (préfixe des frames)
+};
+
+// Statistiques d'une arme, indexées par Weapon::Type
+struct WeaponArchetype {
+	const char*	_name;				// Clé dans ARCHETYPE_FILE
+	const char*	_label;				// Nom affiché dans le HUD
+	Color		_color;				// Indicateur de visée
+	float		_damage;
+	float		_range;
+	float		_cooldown;
+	float		_shot_speed;			// 0 = arme de mêlée
+	float		_shot_radius;
+	float		_shot_lifetime;
+};
+
+// Tables d'archétypes en vigueur : copie des valeurs constexpr par défaut
+// (archetypes.cpp), éventuellement surchargées par un fichier au démarrage.
+struct ArchetypeTable {
+	EntityArchetype	_entities[ENTITY_ARCHETYPE_COUNT];
+	WeaponArchetype	_weapons[WEAPON_ARCHETYPE_COUNT];
+
+	ArchetypeTable();
+	void		reset();
+	int			load(const std::string& file);
+	const EntityArchetype&	entity(int index) const { return _entities[index]; }
+	const WeaponArchetype&	weapon(int index) const { return _weapons[index]; }
+};
+
+ArchetypeTable&	archetypes();
+
+// Projectile créé pendant l'update parallèle, avant fusion dans Game::_projectiles.
+// _source (indice de l'ennemi) donne un ordre de fusion indépendant des threads.
+struct SpawnedProjectile {
+	uint32_t	_source;
+	Projectile	_projectile;
+};
+
+// Poignée stable vers un élément d'un conteneur à swap-remove :
+// reste valide quand l'élément change d'indice, invalidée à sa suppression.
+struct Handle {
+	uint32_t	_slot;
+	uint32_t	_generation;
+
+	Handle() : _slot(UINT32_MAX), _generation(0) {}
+	Handle(uint32_t slot, uint32_t generation) : _slot(slot), _generation(generation) {}
+
+	bool		operator==(const Handle& h) const {
+		return _slot == h._slot && _generation == h._generation;
+	}
+
+	bool		operator!=(const Handle& h) const {
+		return !(*this == h);
+	}
+};
+
+// Table slot <-> indice dense partagée par les conteneurs à swap-remove.
+// Chaque slot porte une génération incrémentée à sa libération.
+struct HandleTable {
+	std::vector<uint32_t>		_slot_of;			// Indice dense -> slot
+	std::vector<uint32_t>		_index_of;			// Slot -> indice dense (UINT32_MAX si libre)
+	std::vector<uint32_t>		_generation;		// Slot -> génération
+	std::vector<uint32_t>		_free_slots;
+
+	void		clear();
+	void		reserve(size_t n);
+	Handle		acquire(uint32_t index);
+	void		release(size_t i);
+	void		swap(size_t i, size_t j);
+	void		save(Snapshot& out) const;
+	void		restore(Snapshot& in);
+	Handle		handle(size_t i) const;
+	bool		valid(Handle h) const;
+	int			index(Handle h) const;
+};
+
+// Stockage SoA des ennemis : un tableau contigu par champ, ennemis groupés par
+// archétype (plage [_type_start[a], _type_start[a + 1]) pour l'archétype a).
+// Ajout et suppression gardent les groupes contigus en déplaçant au plus un
+// ennemi par groupe : l'ordre n'est pas conservé, utiliser une Handle pour
+// suivre un ennemi.
+struct EntityStore {
+	// Champs chauds : parcourus à chaque tick
+	std::vector<float>			_pos_x;
+	std::vector<float>			_pos_y;
+	std::vector<float>			_prev_x;			// Position au tick précédent (rendu)
+	std::vector<float>			_prev_y;
+	std::vector<float>			_vel_x;
+	std::vector<float>			_vel_y;
+	std::vector<float>			_radius;
+	std::vector<float>			_hp;
+	std::vector<uint8_t>		_alive;
+	// Champs froids
+	std::vector<uint8_t>		_archetype;
+	std::vector<float>			_max_hp;
+	std::vector<float>			_speed;
+	std::vector<float>			_dammage;
+	std::vector<float>			_shoot_timer;
+	std::vector<float>			_shoot_cooldown;
+	size_t						_type_start[ENTITY_ARCHETYPE_COUNT + 1];
+	// Tampons de spawn par worker (réutilisés d'un tick à l'autre)
+	std::vector<std::vector<SpawnedProjectile>>	_spawn_buffers;
+	HandleTable					_handles;
+
+	size_t		size() const { return _pos_x.size(); }
+	size_t		capacity() const { return _pos_x.capacity(); }
+	bool		empty() const { return _pos_x.empty(); }
+	Vector2f	pos(size_t i) const { return Vector2f(_pos_x[i], _pos_y[i]); }
+	void		set_pos(size_t i, const Vector2f& p) { _pos_x[i] = p._x; _pos_y[i] = p._y; }
+
+	void		clear();
+	void		reserve(size_t n);
+	EntityStore();
+	Handle		spawn(const Entity& e);
+	size_t		type_begin(int archetype) const { return _type_start[archetype]; }
+	size_t		type_end(int archetype) const { return _type_start[archetype + 1]; }
+	Handle		handle(size_t i) const { return _handles.handle(i); }
+	bool		valid(Handle h) const { return _handles.valid(h); }
+	int			index(Handle h) const { return _handles.index(h); }
+	Entity		get(size_t i) const;
+	void		damage(size_t i, float amount);
+	size_t		remove_dead();
+	void		remove(size_t i);
+	void		swap_entities(size_t i, size_t j);
+	void		save(Snapshot& out) const;
+	void		restore(Snapshot& in);
+
+	// Comportement (monster.cpp)
+	void		save_previous();
+	void		update(float dt, const Player& player, const Room& room, const FlowField& flow,
+					ProjectilePool& projectiles, JobSystem& jobs, std::pmr::memory_resource* frame);
+	void		update_range(size_t begin, size_t end, float dt, const Player& player, const Room& room,
+					const FlowField& flow, std::vector<SpawnedProjectile>& spawns);
+	void		draw(float alpha, float time, const SpatialGrid& grid, const Rectangle& view) const;
+};
+
+// Pool de projectiles à capacité fixe : tableau dense des vivants, slots libres
+// recyclés, poignées générationnelles. Aucune allocation après la construction.
+struct ProjectilePool {
+	std::vector<Projectile>	_items;				// Vivants, contigus (capacité réservée)
+	HandleTable				_handles;
+	size_t					_capacity;
+	size_t					_high_water;		// Plus grand nombre de projectiles simultanés
+	size_t					_exhausted;			// Spawns refusés faute de place
+
+	ProjectilePool(size_t capacity = PROJECTILE_POOL_CAPACITY);
+	size_t		size() const { return _items.size(); }
+	bool		empty() const { return _items.empty(); }
+	Projectile&	operator[](size_t i) { return _items[i]; }
+	const Projectile&	operator[](size_t i) const { return _items[i]; }
+	Projectile*	begin() { return _items.data(); }
+	Projectile*	end() { return _items.data() + _items.size(); }
+	const Projectile*	begin() const { return _items.data(); }
+	const Projectile*	end() const { return _items.data() + _items.size(); }
+
+	Handle		spawn(const Projectile& p);
+	bool		valid(Handle h) const { return _handles.valid(h); }
+	Projectile*	get(Handle h);
+	void		clear();
+	size_t		remove_dead();
+	void		swap_remove(size_t i);
+	void		save(Snapshot& out) const;
+	void		restore(Snapshot& in);
+};
+
+// Tuiles d'une salle par chunks de TILE_CHUNK_SIZE x TILE_CHUNK_SIZE octets
+// (Room::Tile, ligne par ligne dans le chunk). Un chunk d'une seule valeur
+// (mur plein, sol dégagé) n'est stocké que par cette valeur : la mémoire suit
+// le détail de la salle et non sa surface, et les voisines d'une tuile sont
+// presque toujours dans le même bloc de 1 Ko. Les chunks du bord sont
+// complétés par des murs.
+const int		TILE_CHUNK_SHIFT = 5;
+const int		TILE_CHUNK_SIZE = 1 << TILE_CHUNK_SHIFT;
+const int		TILE_CHUNK_MASK = TILE_CHUNK_SIZE - 1;
+const int		TILE_CHUNK_AREA = TILE_CHUNK_SIZE * TILE_CHUNK_SIZE;
+const uint32_t	TILE_CHUNK_UNIFORM = UINT32_MAX;	// Chunk sans bloc détaillé
+
+// Vue en lecture seule : les tableaux appartiennent à un TileChunkStore ou au
+// fichier .roomb projeté en mémoire
+struct TileChunks {
+	int				_width;
+	int				_height;
+	int				_chunks_x;
+	int				_chunks_y;
+	const uint32_t*	_block;				// Par chunk : bloc détaillé, ou TILE_CHUNK_UNIFORM
+	const uint8_t*	_value;				// Par chunk : valeur d'un chunk uniforme
+	const uint8_t*	_blocks;			// _block_count blocs de TILE_CHUNK_AREA octets
+	size_t			_block_count;
+
+	TileChunks();
+	size_t		chunk_count() const { return (size_t)_chunks_x * _chunks_y; }
+	size_t		memory_bytes() const { return chunk_count() * (sizeof(uint32_t) + 1) + _block_count * TILE_CHUNK_AREA; }
+	// (x, y) dans la salle, non vérifié
+	uint8_t		get(int x, int y) const {
+		size_t chunk = (size_t)(y >> TILE_CHUNK_SHIFT) * _chunks_x + (x >> TILE_CHUNK_SHIFT);
+		uint32_t block = _block[chunk];
+		if (block == TILE_CHUNK_UNIFORM)
+			return _value[chunk];
+		return _blocks[(size_t)block * TILE_CHUNK_AREA + ((y & TILE_CHUNK_MASK) << TILE_CHUNK_SHIFT) + (x & TILE_CHUNK_MASK)];
+	}
+	void		decode(uint8_t* out) const;
+};
+
+// Stockage possédé des chunks (salles texte, édition)
+struct TileChunkStore {
+	int						_width;
+	int						_height;
+	int						_chunks_x;
+	int						_chunks_y;
+	std::vector<uint32_t>	_block;
+	std::vector<uint8_t>	_value;
+	std::vector<uint8_t>	_blocks;
+
+	TileChunkStore();
+	void		assign(int width, int height, const uint8_t* tiles);
+	void		copy(const TileChunks& tiles);
+	void		set(int x, int y, uint8_t value);
+	TileChunks	view() const;
+};
+
+// Format binaire des salles (.roomb, produit par tools/room_compiler) :
+// en-tête fixe, puis à _tiles_offset les tables des chunks (uint32 bloc, puis
+// uint8 valeur, chunk_count() chacune), puis _block_count blocs détaillés, puis
+// _meta_size octets de métadonnées texte "clé=valeur\n". Little-endian. Les
+// chunks sont lus en place dans le fichier projeté.
+const char		ROOM_BINARY_MAGIC[4] = {'C', 'F', 'V', 'R'};
+const uint16_t	ROOM_BINARY_VERSION = 2;
+const std::string	ROOM_BINARY_EXT = ".roomb";
+
+struct RoomFileHeader {
+	char		_magic[4];
+	uint16_t	_version;
+	uint16_t	_flags;				// Réservé (0)
+	uint32_t	_width;
+	uint32_t	_height;
+	uint32_t	_tiles_offset;		// Depuis le début du fichier (multiple de 4)
+	uint32_t	_block_count;		// Chunks détaillés
+	uint32_t	_meta_size;			// Octets de métadonnées après les blocs
+	uint32_t	_reserved;			// 0
+};
+static_assert(sizeof(RoomFileHeader) == 32, "RoomFileHeader doit rester packé");
+
+// Fichier projeté en lecture seule, démappé à la destruction
+struct MappedFile {
+	const uint8_t*	_data;
+	size_t			_size;
+
+	MappedFile();
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	bool		open(const std::string& path);
+	void		close();
 };
 
 struct Room {
@@ -185,47 +926,374 @@ struct Room {
 	int					_width;
 	int					_height;
 	int					_tile_size;
-	std::vector<int>	_tiles;
+	float				_inv_tile_size;
+	std::shared_ptr<const RoomTemplate>	_template;	// Tuiles + analyse, partagées
+	const TileChunks*	_tiles;					// Cache de &_template->_tiles
 	int					_room_id;
 	Vector2f			_world_offset;
 
 	Room();
 	Room(int w, int h, int tile_size);
 	bool		load_from_file(const std::string& filename, int tile_size);
+	void		bind(std::shared_ptr<const RoomTemplate> tpl, int tile_size);
+	const TileChunks&	tiles() const { return *_tiles; }
+	const RoomAnalysis&	analysis() const;
 	Tile		get_tile(int x, int y) const;
 	void		set_tile(int x, int y, Tile t);
 	bool		in_bounds(int x, int y) const;
+	Vector2f	tile_center(int index) const;
 	Vector2f	get_spawn() const;
 	Vector2f	get_door_position(Tile door_type) const;
+	int			component_at(const Vector2f& pos) const;
+	int			door_component(Tile door_type) const;
+	int			clearance_at(int x, int y) const;
+	int			spawn_candidates(float radius, int component, const int*& first) const;
+	bool		random_spawn_point(float radius, int component, Rng& rng, Vector2f& out) const;
 	bool		is_walkable(const Vector2f& pos, float radius) const;
-	void		draw() const;
+	bool		sweep_circle(const Vector2f& from, const Vector2f& to, float radius, float& t_hit) const;
+	void		tile_range(const Rectangle& view, int& x0, int& y0, int& x1, int& y1) const;
+	void		draw(const Rectangle& view) const;
+	void		draw_tiles(const Vector2f& origin, int x0, int y0, int x1, int y1) const;
+};
+
+// Analyse faite une fois par template au chargement : portes, points de spawn
+// et connexité. Indices de tuiles = y * width + x.
+struct RoomAnalysis {
+	int						_first_open;		// Première tuile praticable (ordre ligne), -1 si aucune
+	std::vector<int>		_doors[4];			// Tuiles de porte par direction (N, S, E, O)
+	std::vector<uint8_t>	_clearance;			// Distance en tuiles (Chebyshev) au mur le plus proche
+	std::vector<uint64_t>	_wall_mask;			// 1 bit par tuile (1 = mur), lignes de _mask_stride mots
+	int						_mask_stride;
+	std::vector<int>		_component;			// Composante 4-connexe des tuiles praticables (-1 = mur)
+	int						_component_count;
+	std::vector<int>		_spawns;			// Tuiles FLOOR par composante, dégagement décroissant
+	std::vector<int>		_component_spawns;	// Début de chaque composante dans _spawns (+1 sentinelle)
+
+	RoomAnalysis();
+	void		build(const TileChunks& tiles, std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
+	bool		is_wall(int x, int y) const { return (_wall_mask[y * _mask_stride + (x >> 6)] >> (x & 63)) & 1; }
+	static int	door_index(Room::Tile door_type) { return (int)door_type - (int)Room::DOOR_N; }
+};
+
+// Salle du catalogue telle que lue sur disque : parsée une seule fois, jamais
+// modifiée ensuite, et partagée par toutes les Room qui la visitent (flyweight).
+struct RoomTemplate {
+	std::string				_file;
+	int						_width;
+	int						_height;
+	TileChunkStore			_store;				// Format texte, édition : chunks possédés
+	MappedFile				_mapping;			// Format binaire : fichier gardé projeté
+	TileChunks				_tiles;				// Vue sur _store ou sur _mapping
+	RoomAnalysis			_analysis;
+
+	RoomTemplate();
+	RoomTemplate(const RoomTemplate&) = delete;
+	RoomTemplate& operator=(const RoomTemplate&) = delete;
+	bool		load(const std::string& filename, std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
+	bool		load_text(const std::string& filename, std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
+	bool		load_binary(const std::string& filename);
+	void		assign(int width, int height, const uint8_t* tiles);
+	void		use_store(std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
+	bool		save_binary(const std::string& filename, const std::string& meta) const;
+	Room::Tile	get_tile(int x, int y) const { return (Room::Tile)_tiles.get(x, y); }
+};
+
+// Templates indexés par fichier. Rempli à la demande (première visite ou
+// préchargement), partagé entre le thread principal et le prefetcher.
+struct RoomTemplateCache {
+	std::mutex			_lock;
+	std::unordered_map<std::string, std::shared_ptr<const RoomTemplate>>	_templates;
+	int					_loads;				// Fichiers réellement parsés
+
+	RoomTemplateCache();
+	std::shared_ptr<const RoomTemplate>	find(const std::string& file);
+	std::shared_ptr<const RoomTemplate>	load(const std::string& file,
+					std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
+	size_t		size();
+};
+
+// Couche statique des tuiles : cuite une fois par salle dans une render texture,
+// puis dessinée en un seul blit par frame, limité à la partie visible. Retombe
+// sur le dessin des tuiles visibles une à une si la texture ne peut pas être
+// créée (pas de fenêtre, salle trop grande).
+struct TileLayer {
+	RenderTexture2D	_target;
+	bool			_loaded;			// _target alloué côté GPU
+	bool			_dirty;				// Salle changée depuis la dernière cuisson
+	int				_bakes;
+
+	TileLayer();
+	void		invalidate();
+	bool		bake(const Room& room);
+	void		draw(const Room& room, const Rectangle& view);
+	void		unload();
+};
+
+// Grille uniforme (une cellule par tuile) pour le broadphase entre entités.
+// Reconstruite par counting sort : les indices d'une cellule sont contigus.
+struct SpatialGrid {
+	Vector2f			_origin;
+	float				_cell_size;
+	float				_inv_cell_size;
+	int					_cols;
+	int					_rows;
+	float				_max_radius;		// Plus grand rayon inséré (élargit les requêtes)
+	std::vector<int>	_cell_start;		// Début de chaque cellule dans _items (+1 sentinelle)
+	std::vector<int>	_items;				// Indices d'entités triés par cellule
+	std::vector<float>	_xs;				// Copies packées (même ordre que _items)
+	std::vector<float>	_ys;				// pour les kernels de collision
+	std::vector<float>	_rs;
+	std::vector<int>	_item_cell;			// Cellule de chaque entité (-1 si morte)
+
+	SpatialGrid();
+	void		build(const EntityStore& entities, const Room& room);
+	void		reserve(size_t n);
+	int			cell_x(float x) const;
+	int			cell_y(float y) const;
+
+	// Appelle fn(index) pour chaque entité dont le cercle peut toucher (pos, radius).
+	// Le test exact reste à la charge de l'appelant.
+	template <typename Fn>
+	void		for_each_candidate(const Vector2f& pos, float radius, Fn fn) const {
+		if (_items.empty())
+			return;
+		float reach = radius + _max_radius;
+		int x0 = cell_x(pos._x - reach);
+		int x1 = cell_x(pos._x + reach);
+		int y0 = cell_y(pos._y - reach);
+		int y1 = cell_y(pos._y + reach);
+		for (int cy = y0; cy <= y1; ++cy) {
+			const int* start = &_cell_start[cy * _cols];
+			for (int i = start[x0]; i < start[x1 + 1]; ++i)
+				fn(_items[i]);
+		}
+	}
+
+	// Appelle fn(index) pour chaque entité rangée dans une cellule qui touche le
+	// rectangle [lo, hi] élargi du plus grand rayon (culling du rendu)
+	template <typename Fn>
+	void		for_each_in_rect(const Vector2f& lo, const Vector2f& hi, Fn fn) const {
+		if (_items.empty())
+			return;
+		int x0 = cell_x(lo._x - _max_radius);
+		int x1 = cell_x(hi._x + _max_radius);
+		int y0 = cell_y(lo._y - _max_radius);
+		int y1 = cell_y(hi._y + _max_radius);
+		for (int cy = y0; cy <= y1; ++cy) {
+			const int* start = &_cell_start[cy * _cols];
+			for (int i = start[x0]; i < start[x1 + 1]; ++i)
+				fn(_items[i]);
+		}
+	}
+
+	// Appelle fn(index) pour chaque entité qui chevauche exactement (pos, radius),
+	// d'après les positions au moment du build. Kernel SIMD sur chaque ligne de cellules.
+	template <typename Fn>
+	void		for_each_overlap(const Vector2f& pos, float radius, Fn fn) const {
+		if (_items.empty())
+			return;
+		float reach = radius + _max_radius;
+		int x0 = cell_x(pos._x - reach);
+		int x1 = cell_x(pos._x + reach);
+		int y0 = cell_y(pos._y - reach);
+		int y1 = cell_y(pos._y + reach);
+		uint32_t hits[OVERLAP_BATCH];
+		for (int cy = y0; cy <= y1; ++cy) {
+			const int* start = &_cell_start[cy * _cols];
+			for (int i = start[x0]; i < start[x1 + 1]; i += OVERLAP_BATCH) {
+				size_t n = std::min(OVERLAP_BATCH, (size_t)(start[x1 + 1] - i));
+				size_t count = circle_overlaps(pos._x, pos._y, radius, &_xs[i], &_ys[i], &_rs[i], n, hits);
+				for (size_t k = 0; k < count; ++k)
+					fn(_items[i + hits[k]]);
+			}
+		}
+	}
+
+	// Appelle fn(index) pour chaque entité qu'un cercle de ce rayon balayant
+	// [from, to] peut toucher : cellules traversées (DDA) et voisines à portée.
+	// Le parcours s'arrête dès que la cellule suivante est entrée après t_stop,
+	// le meilleur contact de l'appelant (mis à jour par fn). Une entité peut être
+	// proposée plusieurs fois ; le test exact reste à la charge de l'appelant.
+	template <typename Fn>
+	void		for_each_along(const Vector2f& from, const Vector2f& to, float radius,
+					const float& t_stop, Fn fn) const {
+		if (_items.empty())
+			return;
+		int reach = (int)std::ceil((radius + _max_radius) * _inv_cell_size);
+		Vector2f a = (from - _origin) * _inv_cell_size;
+		Vector2f b = (to - _origin) * _inv_cell_size;
+		grid_traverse(a, b, [&](int cx, int cy, float t_enter) {
+			if (t_enter > t_stop)
+				return false;
+			int x0 = std::max(cx - reach, 0);
+			int x1 = std::min(cx + reach, _cols - 1);
+			int y0 = std::max(cy - reach, 0);
+			int y1 = std::min(cy + reach, _rows - 1);
+			for (int y = y0; y <= y1 && x0 <= x1; ++y) {
+				const int* start = &_cell_start[y * _cols];
+				for (int i = start[x0]; i < start[x1 + 1]; ++i)
+					fn(_items[i]);
+			}
+			return true;
+		});
+	}
+};
+
+// Champ de direction vers le joueur, partagé par tous les ennemis : BFS depuis
+// la tuile du joueur, refait seulement quand il change de tuile ou de salle.
+// Les distances sont 4-connexes (pas de tuile orthogonaux). Chaque tuile
+// praticable pointe vers sa voisine la plus proche de la cible, diagonales
+// comprises (sans couper les coins) ; -1 sur la cible et hors d'atteinte.
+struct FlowField {
+	const TileChunks*	_tiles;				// Salle pour laquelle le champ est valide
+	Vector2f			_origin;
+	int					_width;
+	int					_height;
+	int					_tile_size;
+	int					_target;			// Tuile de la cible (-1 = champ vide)
+	std::vector<int>	_distance;			// Pas orthogonaux jusqu'à la cible (INT32_MAX = inatteignable)
+	std::vector<int>	_next;				// Tuile suivante vers la cible
+	std::vector<int>	_queue;
+	int					_rebuilds;
+
+	FlowField();
+	bool		update(const Room& room, const Vector2f& target);
+	int			tile_at(const Vector2f& pos) const;
+	Vector2f	tile_center(int index) const;
+	int			distance(int tile) const { return tile < 0 ? INT32_MAX : _distance[tile]; }
+};
+
+// Thread de chargement : parse la prochaine salle pendant que la courante se
+// joue, pour que la transition de porte n'ait plus qu'à échanger la Room.
+struct RoomPrefetcher {
+	RoomTemplateCache*			_cache;			// Où ranger les templates chargés
+	std::thread					_thread;
+	std::mutex					_lock;
+	std::condition_variable		_wake;			// Nouvelle demande ou arrêt
+	std::condition_variable		_done;			// Chargement terminé
+	std::string					_request;		// Demande pas encore commencée
+	std::string					_loading;		// Fichier en cours de chargement
+	bool						_stop;
+	int							_hits;			// Salle prête au moment de la transition
+	int							_misses;		// Attente ou chargement synchrone
+	Arena						_arena;			// Brouillon du thread, remis à zéro à chaque salle
+
+	RoomPrefetcher(RoomTemplateCache* cache);
+	~RoomPrefetcher();
+	RoomPrefetcher(const RoomPrefetcher&) = delete;
+	RoomPrefetcher& operator=(const RoomPrefetcher&) = delete;
+	void		request(const std::string& file);
+	std::shared_ptr<const RoomTemplate>	take(const std::string& file);
+	void		cancel();
+	void		stop();
+	void		worker_loop();
+};
+
+// Catalogue des salles indexé par entier. Dans chaque catégorie, _order est
+// partitionné : les _available premiers ids n'ont pas encore été joués. Un
+// tirage et un marquage sont donc O(1) (échange en fin de partition), sans
+// allocation ni comparaison de chaînes.
+const int	ROOM_CATEGORY_COUNT = 4;		// easy, medium, hard, boss
+
+struct RoomCatalog {
+	std::vector<std::string>	_files;						// id -> chemin
+	std::vector<uint8_t>		_category;					// id -> catégorie
+	std::vector<int>			_position;					// id -> index dans _order
+	std::vector<int>			_order[ROOM_CATEGORY_COUNT];
+	int							_available[ROOM_CATEGORY_COUNT];
+	std::unordered_map<std::string, int>	_ids;			// chemin -> id
+	int							_resets;					// Catalogue épuisé puis remis à zéro
+
+	RoomCatalog();
+	void		clear();
+	int			add(const std::string& file, int category);
+	int			find(const std::string& file) const;
+	size_t		size() const { return _files.size(); }
+	int			count(int category) const { return (int)_order[category].size(); }
+	bool		is_used(int id) const { return _position[id] >= _available[_category[id]]; }
+	void		mark_used(int id);
+	void		reset_used();
+	void		weights(int rooms_visited, float out[ROOM_CATEGORY_COUNT]) const;
+	int			pick(int rooms_visited, Rng& rng, int* category = nullptr);
 };
 
+const char*	room_category_name(int category);
+
+// La caméra suit le joueur, bornée à la salle (centrée sur un axe où la salle
+// tient dans l'écran). Au changement de salle, elle glisse de l'ancienne
+// position vers la nouvelle à _camera_transition_speed.
 struct Dungeon {
 	Room						_active_room;
 	int							_rooms_visited;
 	int							_tile_size;
-	Vector2f					_camera_target;
-	Vector2f					_camera_pos;
+	Vector2f					_camera_target;	// Centre de vue visé au dernier tick
+	Vector2f					_camera_pos;	// Centre de vue pendant une transition
 	float						_camera_transition_speed;
 	bool						_transitioning;
 
-	// Pools de fichiers de salles par difficulté
-	std::vector<std::string>	_easy_files;
-	std::vector<std::string>	_medium_files;
-	std::vector<std::string>	_hard_files;
-	std::vector<std::string>	_boss_files;
-	std::vector<std::string>	_used_files;
+	RoomCatalog					_catalog;		// Salles par difficulté + déjà jouées
+	mutable TileLayer			_tile_layer;	// Cuite au premier draw après un changement de salle
+	RoomTemplateCache			_templates;		// Chaque salle n'est parsée qu'une fois
+	int							_next_room;		// Id de la prochaine salle, tirée dès l'arrivée
+	RoomPrefetcher				_prefetch;		// Précharge _next_room en arrière-plan
+	Rng*						_rng;			// Tirage des salles (celui de Game)
+	Arena						_room_arena;	// Brouillon des chargements synchrones, remis à zéro à chaque salle
 
 	Dungeon();
 	void		init();
 	int			scan_room_files(int tile_size);
-	std::string	pick_next_room_file();
+	int			pick_next_room();
+	bool		load_room(const std::string& file);
 	bool		load_next_room();
-	void		update(float dt);
+	void		activate_room(std::shared_ptr<const RoomTemplate> tpl);
+	void		update(float dt, const Vector2f& focus);
+	Vector2f	camera_center(const Vector2f& focus) const;
+	Camera2D	camera(const Vector2f& focus) const;
 	Room&		current_room();
 	const Room&	current_room() const;
-	void		draw() const;
+	void		save(Snapshot& out) const;
+	bool		restore(Snapshot& in);
+	bool		catalog_matches(const size_t order_size[ROOM_CATEGORY_COUNT]) const;
+	void		draw(const Rectangle& view) const;
+	void		unload_render_cache();
+};
+
+// Vague scriptée : ses apparitions sont réparties sur _duration secondes
+struct WaveDef {
+	uint16_t	_counts[ENTITY_ARCHETYPE_COUNT];	// Apparitions par archétype
+	float		_duration;
+	float		_hp_scale;							// Multiplicateur des PV
+};
+
+// Enchaîne les vagues : une fois toutes les apparitions faites, la suivante
+// démarre après WAVE_PAUSE secondes si la salle est vide, WAVE_INTERVAL sinon
+// (les vagues s'empilent si le joueur ne suit pas). Au début d'une vague, la file des archétypes est remplie
+// (par blocs, puis mélangée) et les points de spawn de chaque archétype sont
+// résolus une fois ; chaque apparition n'est ensuite qu'un tirage dans une
+// plage, sans branche par type ni allocation. Au-delà de la table, la dernière
+// vague est rejouée avec des PV croissants.
+struct WaveSpawner {
+	const WaveDef*			_waves;
+	int						_wave_count;
+	bool					_enabled;
+	int						_wave;				// Vague en cours (-1 = aucune)
+	float					_timer;				// Temps depuis le début de la vague, puis depuis sa fin
+	float					_hp_scale;
+	std::vector<uint8_t>	_queue;				// Archétypes de la vague, dans l'ordre d'apparition
+	size_t					_next;				// Prochaine apparition dans _queue
+	const int*				_candidates[ENTITY_ARCHETYPE_COUNT];	// Tuiles de spawn par archétype
+	int						_candidate_count[ENTITY_ARCHETYPE_COUNT];
+	int						_spawned;			// Total depuis le reset
+
+	WaveSpawner();
+	void			reset();
+	const WaveDef&	wave_def(int wave) const;
+	void			start_wave(int wave, const Room& room, const Vector2f& player_pos, EntityStore& enemies, Rng& rng);
+	void			update(float dt, const Room& room, const Vector2f& player_pos, EntityStore& enemies, Rng& rng);
+	void			enter_room();
+	bool			wave_done() const { return _next >= _queue.size(); }
+	void			save(Snapshot& out, const Room& room) const;
+	void			restore(Snapshot& in, const Room& room);
 };
 
 struct Game {
@@ -233,25 +1301,139 @@ struct Game {
 	GameState				_next_state;
 	Player					_player;
 	Dungeon					_dungeon;
-	std::vector<Entity>		_enemies;
-	std::vector<Projectile>	_projectiles;
+	EntityStore				_enemies;
+	ProjectilePool			_projectiles;
+	SpatialGrid				_enemy_grid;		// Broadphase ennemis (reconstruit à chaque tick)
+	mutable SpatialGrid		_draw_grid;			// Culling des ennemis (reconstruit à chaque draw)
+	FlowField				_flow;				// Chemins vers le joueur, partagés par les ennemis
+	JobSystem				_jobs;				// Update parallèle des ennemis
+	InputState				_input;				// Input du tick courant (fourni par une InputSource)
+	InputState				_pending_input;		// Input de la frame, edges gardés jusqu'au prochain tick
+	int						_tick_rate;			// Ticks de simulation par seconde
+	int						_max_catchup_steps;
+	bool					_doors_locked;		// Portes traitées comme des murs (bench : la salle reste chargée)
+	float					_accumulator;		// Temps de frame pas encore simulé
+	float					_alpha;				// Fraction du tick suivant (interpolation du rendu)
 	float					_time_elapsed;
 	int						_score;
-	int						_wave;
+	WaveSpawner				_spawner;
+	Rng						_rng;				// Seul hasard de la simulation
+	InputRecorder*			_recorder;			// Enregistre chaque tick (nullptr = aucun)
+	InputSource*			_replay;			// Remplace l'input de frame tick par tick (nullptr = aucun)
+	Arena					_frame_arena;		// Allocations transitoires, remise à zéro à chaque tick
 		
 	Game();
 	int			init();
+	void		set_thread_count(int thread_count);
+	int			step_frame(float frame_dt, const InputState& frame_input);
+	void		tick(const InputState& input);
+	void		save_previous_state();
+	float		tick_dt() const;
 	void		update(float dt);
+	Camera2D	camera() const;
 	void		draw() const;
-	void		handle_input();
+	void		handle_input(const InputState& input);
 	void		change_state(GameState new_state);
 	void		spawn_enemy(Entity::Type type, const Vector2f& pos);
+	uint64_t	checksum() const;
+	void		save_snapshot(Snapshot& out) const;
+	bool		restore_snapshot(Snapshot& in);
 };
 
+// ============================================================================
+// SPRITE ATLAS
+// ============================================================================
+
+// Index binaire de l'atlas (.atlas, produit par tools/atlas_packer) : en-tête
+// fixe, puis _page_count AtlasPage, puis _frame_count AtlasFrame triées par
+// nom, puis _names_size octets de noms terminés par '\0'. Les pages sont des
+// PNG à côté de l'index : <index sans .atlas>_<n>.png. Little-endian.
+const char		ATLAS_MAGIC[4] = {'C', 'F', 'V', 'A'};
+const uint16_t	ATLAS_VERSION = 1;
+const int		ATLAS_PAGE_SIZE = 2048;		// Côté max d'une page (px)
+
+struct AtlasFileHeader {
+	char		_magic[4];
+	uint16_t	_version;
+	uint16_t	_flags;				// Réservé (0)
+	uint32_t	_page_count;
+	uint32_t	_frame_count;
+	uint32_t	_names_size;
+	uint32_t	_reserved;			// 0
+};
+static_assert(sizeof(AtlasFileHeader) == 24, "AtlasFileHeader doit rester packé");
+
+struct AtlasPage {
+	uint16_t	_width;
+	uint16_t	_height;
+};
+
+// Image source rognée de ses bords transparents : (_x, _y, _width, _height)
+// dans la page, placée en (_trim_x, _trim_y) dans l'image d'origine
+struct AtlasFrame {
+	uint32_t	_name;				// Décalage dans la table des noms
+	uint16_t	_page;
+	uint16_t	_x;
+	uint16_t	_y;
+	uint16_t	_width;
+	uint16_t	_height;
+	uint16_t	_trim_x;
+	uint16_t	_trim_y;
+	uint16_t	_source_width;
+	uint16_t	_source_height;
+	uint16_t	_reserved;			// 0
+};
+static_assert(sizeof(AtlasFrame) == 24, "AtlasFrame doit rester packé");
+
+// Atlas chargé : l'index en une lecture, puis une lecture (et une texture)
+// par page. Les frames d'une animation sont contiguës (triées par nom).
+struct SpriteAtlas {
+	std::string				_file;
+	std::vector<AtlasPage>	_pages;
+	std::vector<AtlasFrame>	_frames;
+	std::vector<char>		_names;
+	std::vector<Texture2D>	_textures;			// Vide tant que load() n'a pas réussi
+	int						_entity_first[ENTITY_ARCHETYPE_COUNT];	// Animation de chaque archétype,
+	int						_entity_count[ENTITY_ARCHETYPE_COUNT];	// résolue par load() (0 = cercle)
+
+	SpriteAtlas();
+	bool		load_index(const std::string& file);
+	bool		load(const std::string& file);
+	void		unload();
+	bool		loaded() const { return !_textures.empty(); }
+	std::string	page_file(int page) const;
+	const char*	name(int frame) const { return &_names[_frames[frame]._name]; }
+	int			find(const std::string& name) const;
+	int			animation(const char* prefix, int& count) const;
+	void		draw(int frame, const Vector2f& center, float scale, Color tint) const;
+};
+
+SpriteAtlas&	sprite_atlas();
+
 // ============================================================================
 // UTILITY FUNCTIONS
 // ============================================================================
 
+// Compteurs de la frame en cours, remis à zéro au début de Game::draw
+struct RenderStats {
+	int		_draw_calls;		// Appels de dessin raylib émis par le jeu
+	int		_tile_draw_calls;	// Dont ceux de la couche de tuiles
+	int		_texture_switches;	// Changements de page d'atlas entre deux sprites
+	int		_atlas_page;		// Page du dernier sprite + 1 (0 = aucun)
+};
+
+RenderStats&	render_stats();
+
 bool			aabb_collision(Vector2f p1, float r1, Vector2f p2, float r2);
+bool			sweep_circle_circle(const Vector2f& a, const Vector2f& b, float r,
+					const Vector2f& center, float center_r, float& t_hit);
+bool			sweep_circle_box(const Vector2f& a, const Vector2f& b, float r,
+					const Vector2f& lo, const Vector2f& hi, float& t_hit);
 void			resolve_collision(Vector2f& p1, float r1, Vector2f& p2, float r2);
+Rectangle		camera_view(const Camera2D& camera);
+bool			circle_in_rect(const Vector2f& center, float radius, const Rectangle& rect);
+Vector2f		lerp(const Vector2f& a, const Vector2f& b, float t);
+uint64_t		hash_bytes(const void* data, size_t size, uint64_t hash = 14695981039346656037ull);
+// Hasard hors simulation (benchs, outils) ; le jeu utilise Game::_rng
 int				random_int(int min, int max);
+void			random_seed(unsigned int seed);
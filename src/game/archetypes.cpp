@@ -0,0 +1,134 @@
+#include "game.h"
+
+// ============================================================================
+// ARCHETYPES : valeurs par défaut
+// ============================================================================
+
+constexpr EntityArchetype	DEFAULT_ENTITY_ARCHETYPES[ENTITY_ARCHETYPE_COUNT] = {
+	// nom, couleur, rayon, pv, vitesse, dégâts, cadence de tir, tir : vitesse, rayon, échelle dégâts, durée,
+	// animation dans l'atlas
+	{"skeleton", Color{130, 130, 130, 255}, 12.0f, 30.0f, 150.0f, 10.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+		"Character_animation/monsters_idle/skeleton1/v1/"},
+	{"vampire", Color{230, 41, 55, 255}, 8.0f, 20.0f, 280.0f, 5.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+		"Character_animation/monsters_idle/vampire/v1/"},
+	{"priest", Color{0, 228, 48, 255}, 30.0f, 40.0f, 100.0f, 20.0f, 2.0f, 250.0f, 6.0f, 0.5f, 3.0f,
+		"Character_animation/priests_idle/priest1/v1/"},
+	{"unknown", Color{255, 255, 255, 255}, 12.0f, 30.0f, 150.0f, 10.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+		"Character_animation/monsters_idle/skull/v1/"},
+};
+
+constexpr WeaponArchetype	DEFAULT_WEAPON_ARCHETYPES[WEAPON_ARCHETYPE_COUNT] = {
+	// nom, libellé, couleur, dégâts, portée, recharge, tir : vitesse, rayon, durée
+	{"sword", "Epee", Color{255, 255, 255, 255}, 25.0f, 50.0f, 0.5f, 0.0f, 0.0f, 0.0f},
+	{"bow", "Arc", Color{102, 191, 255, 255}, 15.0f, 200.0f, 1.0f, 600.0f, 5.0f, 2.0f},
+	{"staff", "Baton", Color{200, 122, 255, 255}, 20.0f, 100.0f, 0.8f, 400.0f, 8.0f, 2.5f},
+};
+
+static_assert(DEFAULT_ENTITY_ARCHETYPES[Entity::PRIEST]._shoot_cooldown > 0, "le prêtre doit tirer");
+static_assert(DEFAULT_WEAPON_ARCHETYPES[Weapon::SWORD]._shot_speed == 0, "l'épée est une arme de mêlée");
+
+// Champs surchargeables depuis le fichier, par nom
+struct EntityField {
+	const char*				_name;
+	float EntityArchetype::*	_field;
+};
+
+struct WeaponField {
+	const char*				_name;
+	float WeaponArchetype::*	_field;
+};
+
+static const EntityField	ENTITY_FIELDS[] = {
+	{"radius", &EntityArchetype::_radius},
+	{"hp", &EntityArchetype::_hp},
+	{"speed", &EntityArchetype::_speed},
+	{"damage", &EntityArchetype::_dammage},
+	{"shoot_cooldown", &EntityArchetype::_shoot_cooldown},
+	{"shot_speed", &EntityArchetype::_shot_speed},
+	{"shot_radius", &EntityArchetype::_shot_radius},
+	{"shot_damage_scale", &EntityArchetype::_shot_damage_scale},
+	{"shot_lifetime", &EntityArchetype::_shot_lifetime},
+};
+
+static const WeaponField	WEAPON_FIELDS[] = {
+	{"damage", &WeaponArchetype::_damage},
+	{"range", &WeaponArchetype::_range},
+	{"cooldown", &WeaponArchetype::_cooldown},
+	{"shot_speed", &WeaponArchetype::_shot_speed},
+	{"shot_radius", &WeaponArchetype::_shot_radius},
+	{"shot_lifetime", &WeaponArchetype::_shot_lifetime},
+};
+
+// Cherche name dans une table d'éléments ayant un champ _name ; -1 si absent
+template <typename T, size_t N>
+static int	find_by_name(const T (&table)[N], const std::string& name) {
+	for (size_t i = 0; i < N; ++i) {
+		if (name == table[i]._name)
+			return (int)i;
+	}
+	return -1;
+}
+
+// ============================================================================
+// ARCHETYPE TABLE
+// ============================================================================
+
+ArchetypeTable::ArchetypeTable() {
+	reset();
+}
+
+void	ArchetypeTable::reset() {
+	std::copy(std::begin(DEFAULT_ENTITY_ARCHETYPES), std::end(DEFAULT_ENTITY_ARCHETYPES), _entities);
+	std::copy(std::begin(DEFAULT_WEAPON_ARCHETYPES), std::end(DEFAULT_WEAPON_ARCHETYPES), _weapons);
+}
+
+// Repart des valeurs par défaut puis applique les lignes du fichier :
+//   entity <nom> <champ> <valeur>
+//   weapon <nom> <champ> <valeur>
+// '#' commence un commentaire. Renvoie le nombre de valeurs surchargées
+// (0 si le fichier n'existe pas).
+int		ArchetypeTable::load(const std::string& file) {
+	reset();
+	std::ifstream in(file);
+	if (!in)
+		return 0;
+
+	int applied = 0;
+	int line_number = 0;
+	std::string line;
+	while (std::getline(in, line)) {
+		++line_number;
+		line = line.substr(0, line.find('#'));
+		std::istringstream fields(line);
+		std::string kind, name, field;
+		float value;
+		if (!(fields >> kind))
+			continue;
+		if (!(fields >> name >> field >> value)) {
+			printf("WARNING: %s:%d: expected '<entity|weapon> <name> <field> <value>'\n", file.c_str(), line_number);
+			continue;
+		}
+
+		int archetype = -1;
+		int index = -1;
+		if (kind == "entity" && (archetype = find_by_name(_entities, name)) >= 0
+			&& (index = find_by_name(ENTITY_FIELDS, field)) >= 0)
+			_entities[archetype].*ENTITY_FIELDS[index]._field = value;
+		else if (kind == "weapon" && (archetype = find_by_name(_weapons, name)) >= 0
+			&& (index = find_by_name(WEAPON_FIELDS, field)) >= 0)
+			_weapons[archetype].*WEAPON_FIELDS[index]._field = value;
+		else {
+			printf("WARNING: %s:%d: unknown archetype or field '%s %s %s'\n",
+				file.c_str(), line_number, kind.c_str(), name.c_str(), field.c_str());
+			continue;
+		}
+		++applied;
+	}
+	printf("DEBUG: Applied %d archetype overrides from %s\n", applied, file.c_str());
+	return applied;
+}
+
+ArchetypeTable&	archetypes() {
+	static ArchetypeTable table;
+	return table;
+}
@@ -0,0 +1,248 @@
+#include "game.h"
+
+// ============================================================================
+// HANDLE TABLE
+// ============================================================================
+
+// Les slots restent réservés : les anciennes poignées deviennent invalides
+void	HandleTable::clear() {
+	_slot_of.clear();
+	_free_slots.clear();
+	for (uint32_t slot = (uint32_t)_index_of.size(); slot-- > 0;) {
+		_index_of[slot] = UINT32_MAX;
+		_generation[slot]++;
+		_free_slots.push_back(slot);
+	}
+}
+
+void	HandleTable::reserve(size_t n) {
+	_slot_of.reserve(n);
+	_index_of.reserve(n);
+	_generation.reserve(n);
+	_free_slots.reserve(n);
+}
+
+// Associe un slot (recyclé si possible) au nouvel élément placé à `index`
+Handle	HandleTable::acquire(uint32_t index) {
+	uint32_t slot;
+	if (!_free_slots.empty()) {
+		slot = _free_slots.back();
+		_free_slots.pop_back();
+	} else {
+		slot = (uint32_t)_index_of.size();
+		_index_of.push_back(UINT32_MAX);
+		_generation.push_back(0);
+		// Assez de place pour libérer tous les slots : release() n'alloue jamais
+		if (_free_slots.capacity() < _index_of.size())
+			_free_slots.reserve(_index_of.capacity());
+	}
+	_index_of[slot] = index;
+	_slot_of.push_back(slot);
+	return Handle(slot, _generation[slot]);
+}
+
+// Miroir d'un swap-remove : le dernier élément prend la place de i
+void	HandleTable::release(size_t i) {
+	size_t last = _slot_of.size() - 1;
+	uint32_t slot = _slot_of[i];
+	if (i != last) {
+		_slot_of[i] = _slot_of[last];
+		_index_of[_slot_of[i]] = (uint32_t)i;
+	}
+	_slot_of.pop_back();
+	_index_of[slot] = UINT32_MAX;
+	_generation[slot]++;
+	_free_slots.push_back(slot);
+}
+
+// Deux éléments échangent leurs indices denses
+void	HandleTable::swap(size_t i, size_t j) {
+	std::swap(_slot_of[i], _slot_of[j]);
+	_index_of[_slot_of[i]] = (uint32_t)i;
+	_index_of[_slot_of[j]] = (uint32_t)j;
+}
+
+Handle	HandleTable::handle(size_t i) const {
+	uint32_t slot = _slot_of[i];
+	return Handle(slot, _generation[slot]);
+}
+
+bool	HandleTable::valid(Handle h) const {
+	return h._slot < _index_of.size() && _generation[h._slot] == h._generation
+		&& _index_of[h._slot] != UINT32_MAX;
+}
+
+int		HandleTable::index(Handle h) const {
+	return valid(h) ? (int)_index_of[h._slot] : -1;
+}
+
+// ============================================================================
+// ENTITY STORE (SoA)
+// ============================================================================
+
+EntityStore::EntityStore() {
+	std::fill(_type_start, _type_start + ENTITY_ARCHETYPE_COUNT + 1, 0);
+}
+
+void	EntityStore::clear() {
+	_pos_x.clear();
+	_pos_y.clear();
+	_prev_x.clear();
+	_prev_y.clear();
+	_vel_x.clear();
+	_vel_y.clear();
+	_radius.clear();
+	_hp.clear();
+	_alive.clear();
+	_archetype.clear();
+	_max_hp.clear();
+	_speed.clear();
+	_dammage.clear();
+	_shoot_timer.clear();
+	_shoot_cooldown.clear();
+	_handles.clear();
+	std::fill(_type_start, _type_start + ENTITY_ARCHETYPE_COUNT + 1, 0);
+}
+
+void	EntityStore::reserve(size_t n) {
+	_pos_x.reserve(n);
+	_pos_y.reserve(n);
+	_prev_x.reserve(n);
+	_prev_y.reserve(n);
+	_vel_x.reserve(n);
+	_vel_y.reserve(n);
+	_radius.reserve(n);
+	_hp.reserve(n);
+	_alive.reserve(n);
+	_archetype.reserve(n);
+	_max_hp.reserve(n);
+	_speed.reserve(n);
+	_dammage.reserve(n);
+	_shoot_timer.reserve(n);
+	_shoot_cooldown.reserve(n);
+	_handles.reserve(n);
+	// Au plus un projectile par ennemi et par tick
+	for (auto& buffer : _spawn_buffers)
+		buffer.reserve(n);
+}
+
+Handle	EntityStore::spawn(const Entity& e) {
+	Handle h = _handles.acquire((uint32_t)size());
+
+	_pos_x.push_back(e._pos._x);
+	_pos_y.push_back(e._pos._y);
+	_prev_x.push_back(e._pos._x);
+	_prev_y.push_back(e._pos._y);
+	_vel_x.push_back(e._vel._x);
+	_vel_y.push_back(e._vel._y);
+	_radius.push_back(e._radius);
+	_hp.push_back(e._hp);
+	_alive.push_back(e._alive ? 1 : 0);
+	_archetype.push_back(e._archetype);
+	_max_hp.push_back(e._max_hp);
+	_speed.push_back(e._speed);
+	_dammage.push_back(e._dammage);
+	_shoot_timer.push_back(e._shoot_timer);
+	_shoot_cooldown.push_back(e._shoot_cooldown);
+
+	// Ajouté en fin de tableau : le premier ennemi de chaque groupe suivant
+	// passe en fin de son groupe pour libérer la place en fin du groupe visé
+	size_t at = size() - 1;
+	for (int a = ENTITY_ARCHETYPE_COUNT - 1; a > e._archetype; --a) {
+		swap_entities(_type_start[a], at);
+		at = _type_start[a]++;
+	}
+	_type_start[ENTITY_ARCHETYPE_COUNT] = size();
+	return h;
+}
+
+// Copie AoS d'un ennemi (outils, debug)
+Entity	EntityStore::get(size_t i) const {
+	Entity e((Entity::Type)_archetype[i], pos(i));
+	e._vel = Vector2f(_vel_x[i], _vel_y[i]);
+	e._radius = _radius[i];
+	e._hp = _hp[i];
+	e._max_hp = _max_hp[i];
+	e._alive = _alive[i] != 0;
+	e._speed = _speed[i];
+	e._dammage = _dammage[i];
+	e._shoot_timer = _shoot_timer[i];
+	e._shoot_cooldown = _shoot_cooldown[i];
+	return e;
+}
+
+// Mémorise les positions avant un tick (interpolation du rendu)
+void	EntityStore::save_previous() {
+	std::copy(_pos_x.begin(), _pos_x.end(), _prev_x.begin());
+	std::copy(_pos_y.begin(), _pos_y.end(), _prev_y.begin());
+}
+
+void	EntityStore::damage(size_t i, float amount) {
+	_hp[i] -= amount;
+	if (_hp[i] <= 0)
+		_alive[i] = 0;
+}
+
+// Supprime les ennemis morts en fin de tick ; renvoie le nombre retiré.
+// Parcours à rebours : les ennemis déplacés par remove() sont déjà vérifiés.
+size_t	EntityStore::remove_dead() {
+	size_t removed = 0;
+	for (size_t i = size(); i-- > 0;) {
+		if (!_alive[i]) {
+			remove(i);
+			++removed;
+		}
+	}
+	return removed;
+}
+
+// Le trou descend de groupe en groupe : le dernier de chaque groupe vient le
+// combler, jusqu'à la fin du tableau où il est retiré
+void	EntityStore::remove(size_t i) {
+	int a = _archetype[i];
+	size_t hole = i;
+	for (int b = a; b < ENTITY_ARCHETYPE_COUNT; ++b) {
+		size_t last = _type_start[b + 1] - 1;
+		swap_entities(hole, last);
+		hole = last;
+		_type_start[b + 1]--;
+	}
+	_handles.release(hole);
+
+	_pos_x.pop_back();
+	_pos_y.pop_back();
+	_prev_x.pop_back();
+	_prev_y.pop_back();
+	_vel_x.pop_back();
+	_vel_y.pop_back();
+	_radius.pop_back();
+	_hp.pop_back();
+	_alive.pop_back();
+	_archetype.pop_back();
+	_max_hp.pop_back();
+	_speed.pop_back();
+	_dammage.pop_back();
+	_shoot_timer.pop_back();
+	_shoot_cooldown.pop_back();
+}
+
+void	EntityStore::swap_entities(size_t i, size_t j) {
+	if (i == j)
+		return;
+	_handles.swap(i, j);
+	std::swap(_pos_x[i], _pos_x[j]);
+	std::swap(_pos_y[i], _pos_y[j]);
+	std::swap(_prev_x[i], _prev_x[j]);
+	std::swap(_prev_y[i], _prev_y[j]);
+	std::swap(_vel_x[i], _vel_x[j]);
+	std::swap(_vel_y[i], _vel_y[j]);
+	std::swap(_radius[i], _radius[j]);
+	std::swap(_hp[i], _hp[j]);
+	std::swap(_alive[i], _alive[j]);
+	std::swap(_archetype[i], _archetype[j]);
+	std::swap(_max_hp[i], _max_hp[j]);
+	std::swap(_speed[i], _speed[j]);
+	std::swap(_dammage[i], _dammage[j]);
+	std::swap(_shoot_timer[i], _shoot_timer[j]);
+	std::swap(_shoot_cooldown[i], _shoot_cooldown[j]);
+}
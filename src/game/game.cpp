@@ -7,17 +7,28 @@
 Game::Game()
 	:	_state(GameState::MENU),
 		_next_state(GameState::MENU),
+		_tick_rate(SIM_TICK_RATE),
+		_max_catchup_steps(MAX_CATCHUP_STEPS),
+		_doors_locked(false),
+		_accumulator(0),
+		_alpha(0),
 		_time_elapsed(0),
 		_score(0),
-		_wave(0) {}
+		_rng(std::random_device{}()),
+		_recorder(nullptr),
+		_replay(nullptr),
+		_frame_arena(FRAME_ARENA_SIZE) {
+	_dungeon._rng = &_rng;
+}
 
 int		Game::init() {
 	_state = GameState::MENU;
 	_next_state = GameState::MENU;
 	_time_elapsed = 0;
 	_score = 0;
-	_wave = 0;
 	_dungeon.init();
+	// Archétypes par défaut, surchargés par le fichier de données s'il existe
+	archetypes().load(ARCHETYPE_FILE);
 	// Calculer la taille des tuiles proportionnellement à la résolution
 	float scale_factor = (float)SCREEN_WIDTH / REFERENCE_WIDTH;
 	int tile_size = (int)(REFERENCE_TILE_SIZE * scale_factor);
@@ -31,169 +42,280 @@ int		Game::init() {
 
 	_player.reset();
 	_player._pos = _dungeon.current_room().get_spawn();
+	_player._prev_pos = _player._pos;
 	_enemies.clear();
 	_projectiles.clear();
+	_spawner.reset();
+	_accumulator = 0;
+	_alpha = 0;
 	return 0;
 }
 
+// Threads en plus du thread principal pour l'update des ennemis (0 = séquentiel)
+void	Game::set_thread_count(int thread_count) {
+	_jobs.init(std::max(thread_count, 0));
+}
+
+float	Game::tick_dt() const {
+	return 1.0f / (float)_tick_rate;
+}
+
+// Boucle à pas fixe : le temps de frame est accumulé et consommé par ticks de
+// durée constante. Après un hitch, au plus _max_catchup_steps ticks sont rattrapés,
+// le reste est abandonné. Renvoie le nombre de ticks simulés.
+// En replay, l'input de chaque tick vient de _replay et frame_input est ignoré.
+int		Game::step_frame(float frame_dt, const InputState& frame_input) {
+	float step = tick_dt();
+	_pending_input.merge(frame_input);
+	_accumulator += frame_dt;
+
+	int steps = 0;
+	while (_accumulator >= step && steps < _max_catchup_steps) {
+		if (_replay)
+			_replay->poll(*this, _pending_input);
+		tick(_pending_input);
+		_pending_input.clear_edges();
+		_accumulator -= step;
+		++steps;
+	}
+	if (_accumulator >= step)
+		_accumulator = std::fmod(_accumulator, step);
+
+	_alpha = _accumulator / step;
+	return steps;
+}
+
+// Un tick de simulation complet (durée tick_dt())
+void	Game::tick(const InputState& input) {
+	PROFILE_ZONE("tick");
+	_frame_arena.reset();
+	save_previous_state();
+	handle_input(input);
+	update(tick_dt());
+	if (_recorder)
+		_recorder->record(input, *this);
+}
+
+void	Game::save_previous_state() {
+	_player._prev_pos = _player._pos;
+	_enemies.save_previous();
+	for (auto& proj : _projectiles)
+		proj._prev_pos = proj._pos;
+}
+
 void	Game::update(float dt) {
 	if (_state != GameState::RUNNING)
 		return ;
 	
 	_time_elapsed += dt;
-	_dungeon.update(dt);
+	_dungeon.update(dt, _player._pos);
 	
 	// Update joueur
-	Vector2f prev_pos = _player._pos;
-	_player.update(dt);
+	{
+		PROFILE_ZONE("player");
+		Vector2f prev_pos = _player._pos;
+		_player.update(dt, _input);
 	
-	// Check si le joueur est encore dans la salle ou a changé de salle
-	if (!_dungeon.current_room().is_walkable(_player._pos, _player._radius)) {
-		// Check si on traverse une porte
-		Vector2f local_pos = _player._pos - _dungeon.current_room()._world_offset;
-		int tx = (int)std::floor(local_pos._x / _dungeon.current_room()._tile_size);
-		int ty = (int)std::floor(local_pos._y / _dungeon.current_room()._tile_size);
-		Room::Tile tile = _dungeon.current_room().get_tile(tx, ty);
+		// Check si le joueur est encore dans la salle ou a changé de salle
+		if (!_dungeon.current_room().is_walkable(_player._pos, _player._radius)) {
+			// Check si on traverse une porte
+			Vector2f local_pos = _player._pos - _dungeon.current_room()._world_offset;
+			int tx = (int)std::floor(local_pos._x / _dungeon.current_room()._tile_size);
+			int ty = (int)std::floor(local_pos._y / _dungeon.current_room()._tile_size);
+			Room::Tile tile = _dungeon.current_room().get_tile(tx, ty);
 		
-		if (tile == Room::DOOR_N || tile == Room::DOOR_S || tile == Room::DOOR_E || tile == Room::DOOR_O) {
-			// Charger une nouvelle salle aléatoire (pondérée par la progression)
-			Room::Tile exit_dir = tile;
-			if (_dungeon.load_next_room()) {
-				// Spawn à la porte opposée de la direction de sortie
-				Room::Tile opposite;
-				if (exit_dir == Room::DOOR_N) opposite = Room::DOOR_S;
-				else if (exit_dir == Room::DOOR_S) opposite = Room::DOOR_N;
-				else if (exit_dir == Room::DOOR_E) opposite = Room::DOOR_O;
-				else opposite = Room::DOOR_E;
-
-				Vector2f spawn = _dungeon.current_room().get_door_position(opposite);
-				if (spawn._x >= 0 && spawn._y >= 0)
-					_player._pos = spawn;
-				else
-					_player._pos = _dungeon.current_room().get_spawn();
-				_enemies.clear();
-				_projectiles.clear();
+			if (!_doors_locked
+				&& (tile == Room::DOOR_N || tile == Room::DOOR_S || tile == Room::DOOR_E || tile == Room::DOOR_O)) {
+				// Charger une nouvelle salle aléatoire (pondérée par la progression)
+				Room::Tile exit_dir = tile;
+				if (_dungeon.load_next_room()) {
+					// Spawn à la porte opposée de la direction de sortie
+					Room::Tile opposite;
+					if (exit_dir == Room::DOOR_N) opposite = Room::DOOR_S;
+					else if (exit_dir == Room::DOOR_S) opposite = Room::DOOR_N;
+					else if (exit_dir == Room::DOOR_E) opposite = Room::DOOR_O;
+					else opposite = Room::DOOR_E;
+
+					Vector2f spawn = _dungeon.current_room().get_door_position(opposite);
+					if (spawn._x >= 0 && spawn._y >= 0)
+						_player._pos = spawn;
+					else
+						_player._pos = _dungeon.current_room().get_spawn();
+					// Téléportation : pas d'interpolation depuis l'ancienne salle
+					_player._prev_pos = _player._pos;
+					_enemies.clear();
+					_projectiles.clear();
+					_spawner.enter_room();
+				}
+			} else {
+				// Collision avec le mur, annuler le mouvement
+				_player._pos = prev_pos;
 			}
-		} else {
-			// Collision avec le mur, annuler le mouvement
-			_player._pos = prev_pos;
 		}
 	}
 	
-	// Update ennemis
-	for (auto& enemy : _enemies) {
-		if (enemy._alive) {
-			enemy.update(dt, _player, _dungeon.current_room(), _projectiles);
-			
-			// Check collision avec le joueur
-			if (aabb_collision(_player._pos, _player._radius, enemy._pos, enemy._radius)) {
-				_player._hp -= enemy._dammage * dt;
+	// Update ennemis (IA + déplacement, par passes sur les tableaux SoA)
+	const Room& room = _dungeon.current_room();
+	{
+		PROFILE_ZONE("enemies");
+		_flow.update(room, _player._pos);
+		_enemies.update(dt, _player, room, _flow, _projectiles, _jobs, &_frame_arena);
+	}
+	
+	// Check collision avec le joueur (kernel un-contre-tous, par lots)
+	{
+		PROFILE_ZONE("player_contacts");
+		uint32_t contacts[OVERLAP_BATCH];
+		for (size_t base = 0; base < _enemies.size(); base += OVERLAP_BATCH) {
+			size_t n = std::min(OVERLAP_BATCH, _enemies.size() - base);
+			size_t count = circle_overlaps(_player._pos._x, _player._pos._y, _player._radius,
+				&_enemies._pos_x[base], &_enemies._pos_y[base], &_enemies._radius[base], n, contacts);
+			for (size_t k = 0; k < count; ++k) {
+				size_t i = base + contacts[k];
+				if (!_enemies._alive[i])
+					continue;
+				Vector2f enemy_pos = _enemies.pos(i);
+				float enemy_radius = _enemies._radius[i];
+				_player._hp -= _enemies._dammage[i] * dt;
 				// Sauvegarder la position du joueur avant résolution
 				Vector2f player_pos_before = _player._pos;
 				// Résoudre la collision (repousser le monstre et le joueur)
-				resolve_collision(_player._pos, _player._radius, enemy._pos, enemy._radius);
+				resolve_collision(_player._pos, _player._radius, enemy_pos, enemy_radius);
 				// Vérifier que le joueur n'est pas dans un mur après la résolution
-				if (!_dungeon.current_room().is_walkable(_player._pos, _player._radius)) {
+				if (!room.is_walkable(_player._pos, _player._radius)) {
 					// Si le joueur est dans un mur, le remettre à sa position précédente
 					_player._pos = player_pos_before;
 					// Et pousser seulement l'ennemi dans la direction opposée
-					Vector2f push_dir = (enemy._pos - _player._pos).normalized();
-					enemy._pos = _player._pos + push_dir * (_player._radius + enemy._radius);
+					Vector2f push_dir = (enemy_pos - _player._pos).normalized();
+					enemy_pos = _player._pos + push_dir * (_player._radius + enemy_radius);
 				}
+				_enemies.set_pos(i, enemy_pos);
 			}
 		}
 	}
 	
-	// Gérer les collisions entre les monstres
-	for (size_t i = 0; i < _enemies.size(); ++i) {
-		if (!_enemies[i]._alive)
-			continue;
-		
-		for (size_t j = i + 1; j < _enemies.size(); ++j) {
-			if (!_enemies[j]._alive)
+	// Gérer les collisions entre les monstres (voisins via la grille uniquement)
+	{
+		PROFILE_ZONE("monster_collision");
+		_enemy_grid.build(_enemies, room);
+		for (size_t i = 0; i < _enemies.size(); ++i) {
+			if (!_enemies._alive[i])
 				continue;
-			
-			// Vérifier et résoudre la collision entre deux monstres
-			if (aabb_collision(_enemies[i]._pos, _enemies[i]._radius,
-								_enemies[j]._pos, _enemies[j]._radius)) {
-				resolve_collision(_enemies[i]._pos, _enemies[i]._radius,
-								_enemies[j]._pos, _enemies[j]._radius);
-			}
+		
+			_enemy_grid.for_each_candidate(_enemies.pos(i), _enemies._radius[i], [&](int j) {
+				// Chaque paire n'est traitée qu'une fois (j > i)
+				if (j <= (int)i)
+					return;
+				Vector2f a = _enemies.pos(i);
+				Vector2f b = _enemies.pos(j);
+				if (aabb_collision(a, _enemies._radius[i], b, _enemies._radius[j])) {
+					resolve_collision(a, _enemies._radius[i], b, _enemies._radius[j]);
+					_enemies.set_pos(i, a);
+					_enemies.set_pos(j, b);
+				}
+			});
 		}
-	}
 	
-	// Nettoyer les ennemis morts
-	_enemies.erase(std::remove_if(_enemies.begin(), _enemies.end(), [](const Entity& e) { return !e._alive; }), _enemies.end());
+		// Les positions ont bougé pendant la séparation
+		_enemy_grid.build(_enemies, room);
+	}
 	
 	// Update projectiles
-	for (auto& proj : _projectiles) {
-		proj.update(dt, _dungeon.current_room());
+	{
+		PROFILE_ZONE("projectiles");
+		for (auto& proj : _projectiles) {
+			if (!proj._alive) continue;
 		
-		if (!proj._alive) continue;
+			// Segment parcouru ce tick, déjà coupé au premier mur touché : un
+			// projectile rapide ne traverse plus rien entre deux ticks
+			Vector2f from = proj._pos;
+			proj.update(dt, room);
+			Vector2f to = proj._pos;
 		
-		if (proj._from_player) {
-			// Projectile du joueur -> touche les ennemis
-			for (auto& enemy : _enemies) {
-				if (!enemy._alive) continue;
-				if (aabb_collision(proj._pos, proj._radius, enemy._pos, enemy._radius)) {
-					enemy._hp -= proj._damage;
-					if (enemy._hp <= 0)
-						enemy._alive = false;
+			if (proj._from_player) {
+				// Projectile du joueur -> premier ennemi rencontré sur le segment
+				// (plus petit indice à égalité)
+				float best = 2.0f;
+				int hit = -1;
+				_enemy_grid.for_each_along(from, to, proj._radius, best, [&](int j) {
+					float t;
+					if (!_enemies._alive[j]
+						|| !sweep_circle_circle(from, to, proj._radius, _enemies.pos(j), _enemies._radius[j], t))
+						return;
+					if (t < best || (t == best && j < hit)) {
+						best = t;
+						hit = j;
+					}
+				});
+				if (hit >= 0) {
+					_enemies.damage(hit, proj._damage);
+					proj._pos = lerp(from, to, best);
+					proj._alive = false;
+				}
+			} else {
+				// Projectile ennemi -> touche le joueur
+				float t;
+				if (sweep_circle_circle(from, to, proj._radius, _player._pos, _player._radius, t)) {
+					_player._hp -= proj._damage;
+					proj._pos = lerp(from, to, t);
 					proj._alive = false;
-					break;
 				}
-			}
-		} else {
-			// Projectile ennemi -> touche le joueur
-			if (aabb_collision(proj._pos, proj._radius, _player._pos, _player._radius)) {
-				_player._hp -= proj._damage;
-				proj._alive = false;
 			}
 		}
 	}
 	
-	// Nettoyer les projectiles morts
-	_projectiles.erase(std::remove_if(_projectiles.begin(), _projectiles.end(), 
-		[](const Projectile& p) { return !p._alive; }), _projectiles.end());
-	
-	// Re-nettoyer les ennemis tués par projectiles
-	_enemies.erase(std::remove_if(_enemies.begin(), _enemies.end(), [](const Entity& e) { return !e._alive; }), _enemies.end());
+	// Nettoyer les projectiles et les ennemis morts (en fin de tick)
+	{
+		PROFILE_ZONE("cleanup");
+		_projectiles.remove_dead();
+		_enemies.remove_dead();
+	}
 	
 	// Check si le joueur est mort
 	if (_player._hp <= 0)
 		change_state(GameState::GAME_OVER);
 	
-	// Spawn ennemis au fil du temps dans la salle actuelle
-	/* static float spawn_timer = 0;
-	spawn_timer += dt;
-	if (spawn_timer > 3.0f && _enemies.size() < 10) {
-		Vector2f spawn_pos = _dungeon.current_room().get_spawn();
-		int WhoSpawn = rand() % 3;
-		if (WhoSpawn == 0) {
-			spawn_enemy(Entity::SKELETON, spawn_pos);
-		} else if (WhoSpawn == 1) {
-			spawn_enemy(Entity::VAMPIRE, spawn_pos);
-		} else {
-			spawn_enemy(Entity::PRIEST, spawn_pos);
-		}
-		spawn_timer = 0;
-	} */
+	// Vagues d'ennemis dans la salle actuelle
+	{
+		PROFILE_ZONE("waves");
+		_spawner.update(dt, room, _player._pos, _enemies, _rng);
+		// start_wave a réservé le store pour toute la vague : les grilles
+		// suivent dans le même tick, pas à chaque apparition
+		_enemy_grid.reserve(_enemies.capacity());
+		_draw_grid.reserve(_enemies.capacity());
+	}
 }
 
+// Caméra de la frame : suit la position interpolée du joueur
+Camera2D	Game::camera() const {
+	return _dungeon.camera(lerp(_player._prev_pos, _player._pos, _alpha));
+}
+
+// Le monde est dessiné à travers la caméra et limité à sa vue (tuiles par
+// plage d'indices, ennemis par la grille), le HUD en coordonnées écran
 void	Game::draw() const {
+	PROFILE_ZONE("draw");
+	render_stats() = RenderStats();
 	if (_state == GameState::MENU) {
 		DrawText("CURSE OF THE FRACTURED VEIL", SCREEN_WIDTH/4.07, SCREEN_HEIGHT/2 - 100, 40, WHITE);
 		DrawText("Press SPACE to start", SCREEN_WIDTH/2.37, SCREEN_HEIGHT/2 + 50, 20, GRAY);
 	} else if (_state == GameState::RUNNING) {
-		_dungeon.draw();
-		_player.draw();
-		for (const auto& enemy : _enemies) {
-			enemy.draw();
-		}
+		Camera2D view_camera = camera();
+		Rectangle view = camera_view(view_camera);
+		BeginMode2D(view_camera);
+		_dungeon.draw(view);
+		_player.draw(_alpha);
+		_draw_grid.build(_enemies, _dungeon.current_room());
+		_enemies.draw(_alpha, _time_elapsed, _draw_grid, view);
 		for (const auto& proj : _projectiles) {
-			proj.draw();
+			if (circle_in_rect(proj._pos, proj._radius + VIEW_CULL_MARGIN, view))
+				proj.draw(_alpha);
 		}
-		DrawText(TextFormat("Room: %d | Wave: %d | Time: %.1f", _dungeon._rooms_visited, _wave, _time_elapsed), 10, 60, 20, WHITE);
+		EndMode2D();
+		_player.draw_hud();
+		DrawText(TextFormat("Room: %d | Wave: %d | Time: %.1f", _dungeon._rooms_visited, _spawner._wave + 1, _time_elapsed), 10, 60, 20, WHITE);
+		DrawText(TextFormat("Draw calls: %d (tiles: %d) | Atlas page switches: %d", render_stats()._draw_calls,
+			render_stats()._tile_draw_calls, render_stats()._texture_switches), 10, 85, 20, GRAY);
 	} else if (_state == GameState::GAME_OVER) {
 		DrawText("GAME OVER", SCREEN_WIDTH/2 - 150, SCREEN_HEIGHT/2 - 50, 40, RED);
 		DrawText(TextFormat("Score: %d", _score), SCREEN_WIDTH/2 - 100, SCREEN_HEIGHT/2 + 20, 20, WHITE);
@@ -201,8 +323,9 @@ void	Game::draw() const {
 	}
 }
 
-void	Game::handle_input() {
-	if (IsKeyPressed(KEY_SPACE) || IsKeyPressed(KEY_LEFT_SHIFT)) {
+void	Game::handle_input(const InputState& input) {
+	_input = input;
+	if (input._dash) {
 		if (_state == GameState::MENU) {
 			change_state(GameState::RUNNING);
 		} else if (_state == GameState::RUNNING) {
@@ -218,19 +341,21 @@ void	Game::handle_input() {
 	
 	if (_state == GameState::RUNNING) {
 		// Changement d'arme : touches 1, 2 ou TAB
-		if (IsKeyPressed(KEY_ONE) || IsKeyPressed(KEY_KP_1))
+		if (input._weapon_1)
 			_player._active_weapon = 0;
-		if (IsKeyPressed(KEY_TWO) || IsKeyPressed(KEY_KP_2))
+		if (input._weapon_2)
 			_player._active_weapon = 1;
-		if (IsKeyPressed(KEY_TAB))
+		if (input._switch_weapon)
 			_player.switch_weapon();
 		
 		// Attaque : clic gauche de la souris
-		if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT))
-			_player.attack(_enemies, _projectiles);
+		if (input._attack) {
+			_enemy_grid.build(_enemies, _dungeon.current_room());
+			_player.attack(_enemies, _enemy_grid, _projectiles);
+		}
 	}
 	
-	if (IsKeyPressed(KEY_R) && _state == GameState::GAME_OVER) {
+	if (input._restart && _state == GameState::GAME_OVER) {
 		init();
 	}
 }
@@ -240,5 +365,33 @@ void	Game::change_state(GameState new_state) {
 }
 
 void	Game::spawn_enemy(Entity::Type type, const Vector2f& pos) {
-	_enemies.emplace_back(type, pos);
+	_enemies.spawn(Entity(type, pos));
+}
+
+// Empreinte de l'état simulé (FNV-1a), comparée au replay pour détecter une
+// divergence. Ne couvre pas les champs du rendu (_prev_pos, _alpha).
+uint64_t	Game::checksum() const {
+	uint64_t h = hash_bytes(&_state, sizeof(_state));
+	h = hash_bytes(&_score, sizeof(_score), h);
+	h = hash_bytes(&_time_elapsed, sizeof(_time_elapsed), h);
+	h = hash_bytes(&_dungeon._rooms_visited, sizeof(_dungeon._rooms_visited), h);
+	h = hash_bytes(&_player._pos, sizeof(_player._pos), h);
+	h = hash_bytes(&_player._vel, sizeof(_player._vel), h);
+	h = hash_bytes(&_player._hp, sizeof(_player._hp), h);
+	h = hash_bytes(&_player._active_weapon, sizeof(_player._active_weapon), h);
+	h = hash_bytes(&_player._attack_timer, sizeof(_player._attack_timer), h);
+	h = hash_bytes(&_player._dash_cooldown, sizeof(_player._dash_cooldown), h);
+	size_t n = _enemies.size();
+	h = hash_bytes(&n, sizeof(n), h);
+	h = hash_bytes(_enemies._pos_x.data(), n * sizeof(float), h);
+	h = hash_bytes(_enemies._pos_y.data(), n * sizeof(float), h);
+	h = hash_bytes(_enemies._hp.data(), n * sizeof(float), h);
+	h = hash_bytes(_enemies._archetype.data(), n, h);
+	for (const Projectile& proj : _projectiles) {
+		h = hash_bytes(&proj._pos, sizeof(proj._pos), h);
+		h = hash_bytes(&proj._lifetime, sizeof(proj._lifetime), h);
+	}
+	h = hash_bytes(&_spawner._wave, sizeof(_spawner._wave), h);
+	h = hash_bytes(&_spawner._spawned, sizeof(_spawner._spawned), h);
+	return h;
 }
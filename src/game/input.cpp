@@ -0,0 +1,150 @@
+#include "game.h"
+
+// ============================================================================
+// INPUT STATE
+// ============================================================================
+
+InputState::InputState()
+	:	_move(0, 0),
+		_aim(0, 0),
+		_dash(false),
+		_attack(false),
+		_weapon_1(false),
+		_weapon_2(false),
+		_switch_weapon(false),
+		_restart(false) {}
+
+void	InputState::clear_edges() {
+	_dash = false;
+	_attack = false;
+	_weapon_1 = false;
+	_weapon_2 = false;
+	_switch_weapon = false;
+	_restart = false;
+}
+
+// Fusionne l'input d'une frame : l'état maintenu est remplacé, les edges
+// s'accumulent jusqu'à ce qu'un tick les consomme (aucun appui perdu)
+void	InputState::merge(const InputState& frame) {
+	_move = frame._move;
+	_aim = frame._aim;
+	_dash = _dash || frame._dash;
+	_attack = _attack || frame._attack;
+	_weapon_1 = _weapon_1 || frame._weapon_1;
+	_weapon_2 = _weapon_2 || frame._weapon_2;
+	_switch_weapon = _switch_weapon || frame._switch_weapon;
+	_restart = _restart || frame._restart;
+}
+
+// ============================================================================
+// RAYLIB INPUT (clavier + souris)
+// ============================================================================
+
+void	RaylibInput::poll(const Game& game, InputState& out) {
+	out._move = Vector2f(0, 0);
+	if (IsKeyDown(KEY_W)) out._move._y -= 1;
+	if (IsKeyDown(KEY_S)) out._move._y += 1;
+	if (IsKeyDown(KEY_A)) out._move._x -= 1;
+	if (IsKeyDown(KEY_D)) out._move._x += 1;
+	if (IsKeyDown(KEY_UP)) out._move._y -= 1;
+	if (IsKeyDown(KEY_DOWN)) out._move._y += 1;
+	if (IsKeyDown(KEY_LEFT)) out._move._x -= 1;
+	if (IsKeyDown(KEY_RIGHT)) out._move._x += 1;
+
+	// La visée est en coordonnées monde : la souris passe par la caméra
+	Vector2 mouse = GetScreenToWorld2D(GetMousePosition(), game.camera());
+	out._aim = Vector2f(mouse.x, mouse.y);
+
+	out._dash = IsKeyPressed(KEY_SPACE) || IsKeyPressed(KEY_LEFT_SHIFT);
+	out._attack = IsMouseButtonPressed(MOUSE_BUTTON_LEFT);
+	out._weapon_1 = IsKeyPressed(KEY_ONE) || IsKeyPressed(KEY_KP_1);
+	out._weapon_2 = IsKeyPressed(KEY_TWO) || IsKeyPressed(KEY_KP_2);
+	out._switch_weapon = IsKeyPressed(KEY_TAB);
+	out._restart = IsKeyPressed(KEY_R);
+}
+
+// ============================================================================
+// SCRIPTED INPUT (séquence rejouée tick par tick)
+// ============================================================================
+
+ScriptedInput::ScriptedInput(bool loop) : _cursor(0), _elapsed(0), _loop(loop) {}
+
+void	ScriptedInput::push(int ticks, const InputState& input) {
+	Step step;
+	step._ticks = ticks;
+	step._input = input;
+	_steps.push_back(step);
+}
+
+void	ScriptedInput::poll(const Game& game, InputState& out) {
+	(void)game;
+	if (_cursor >= _steps.size()) {
+		if (!_loop || _steps.empty()) {
+			out = InputState();
+			return;
+		}
+		_cursor = 0;
+	}
+
+	const Step& step = _steps[_cursor];
+	out = step._input;
+	// Les edges ne sont émis qu'au premier tick de l'étape
+	if (_elapsed > 0)
+		out.clear_edges();
+	if (++_elapsed >= step._ticks) {
+		_elapsed = 0;
+		++_cursor;
+	}
+}
+
+// ============================================================================
+// BOT INPUT (joueur synthétique pour les tests de charge)
+// ============================================================================
+
+BotInput::BotInput(float keep_distance) : _keep_distance(keep_distance), _tick(0) {}
+
+void	BotInput::poll(const Game& game, InputState& out) {
+	out = InputState();
+	++_tick;
+
+	if (game._state != GameState::RUNNING) {
+		// Menu / game over : on relance directement
+		out._dash = (game._state == GameState::MENU);
+		out._restart = (game._state == GameState::GAME_OVER);
+		return;
+	}
+
+	const Player& player = game._player;
+	const EntityStore& enemies = game._enemies;
+	int target = -1;
+	float best = 0;
+	for (size_t i = 0; i < enemies.size(); ++i) {
+		if (!enemies._alive[i])
+			continue;
+		float d = (enemies.pos(i) - player._pos).length();
+		if (target < 0 || d < best) {
+			target = (int)i;
+			best = d;
+		}
+	}
+
+	if (target < 0) {
+		out._aim = player._pos + player._facing;
+		return;
+	}
+
+	// Garde ses distances : recule si trop près, avance si trop loin, sinon tourne autour
+	Vector2f target_pos = enemies.pos(target);
+	Vector2f to_target = (target_pos - player._pos).normalized();
+	if (best < _keep_distance)
+		out._move = to_target * -1.0f;
+	else if (best > _keep_distance * 1.5f)
+		out._move = to_target;
+	else
+		out._move = Vector2f(-to_target._y, to_target._x);
+
+	out._aim = target_pos;
+	out._attack = (player._attack_timer <= 0);
+	out._dash = (best < enemies._radius[target] + player._radius * 2.0f);
+	out._switch_weapon = (_tick % 600 == 0);
+}
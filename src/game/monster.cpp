@@ -4,88 +4,228 @@
 // ENTITY
 // ============================================================================
 
-Entity::Entity(Type t, const Vector2f& p) : _type(t), _pos(p), _vel(0, 0), _alive(true), _shoot_timer(0), _shoot_cooldown(0) {
-	if (_type == SKELETON){
-		_radius = 12.0f;
-		_hp = 30.0f;
-		_max_hp = _hp;
-		_speed = 150.0f;
-		_dammage = 10.0f;
-		_shoot_cooldown = 0; // pas de projectile
-	}
-	else if (_type == VAMPIRE) {
-		_radius = 8.0f;
-		_hp = 20.0f;
-		_max_hp = _hp;
-		_speed = 280.0f;
-		_dammage = 5.0f;
-		_shoot_cooldown = 0; // pas de projectile
+Entity::Entity(Type t, const Vector2f& p) : _archetype((uint8_t)t), _pos(p), _vel(0, 0), _alive(true), _shoot_timer(0) {
+	const EntityArchetype& a = archetypes().entity(_archetype);
+	_radius = a._radius;
+	_hp = a._hp;
+	_max_hp = _hp;
+	_speed = a._speed;
+	_dammage = a._dammage;
+	_shoot_cooldown = a._shoot_cooldown;
+}
+
+// ============================================================================
+// ENTITY STORE : comportement
+// ============================================================================
+
+// Comportement propre à chaque archétype, fixé à la compilation. Un nouveau
+// type de monstre = une spécialisation (et une entrée dans UPDATE_KERNELS) ;
+// ses statistiques restent dans la table des archétypes.
+template <int Archetype>
+struct EnemyBehavior {
+	static const bool	SHOOTS = false;			// Tire sur le joueur (cadence _shoot_cooldown)
+};
+
+template <>
+struct EnemyBehavior<Entity::PRIEST> {
+	static const bool	SHOOTS = true;
+};
+
+// Même information indexée par archétype, pour le code qui n'est pas
+// spécialisé (capacité des tampons de tir)
+static const bool	ARCHETYPE_SHOOTS[] = {
+	EnemyBehavior<Entity::SKELETON>::SHOOTS,
+	EnemyBehavior<Entity::VAMPIRE>::SHOOTS,
+	EnemyBehavior<Entity::PRIEST>::SHOOTS,
+	EnemyBehavior<Entity::UNKNOWN>::SHOOTS,
+};
+
+static_assert(sizeof(ARCHETYPE_SHOOTS) / sizeof(ARCHETYPE_SHOOTS[0]) == ENTITY_ARCHETYPE_COUNT,
+	"un trait de tir par archétype");
+
+// Vitesse de chaque ennemi vers la cible, sans branche : la boucle est vectorisée
+static void	steer_towards(size_t n, const float* __restrict x, const float* __restrict y,
+				const float* __restrict r, const float* __restrict speed,
+				float* __restrict vx, float* __restrict vy, Vector2f target, float target_radius) {
+	for (size_t i = 0; i < n; ++i) {
+		float dx = target._x - x[i];
+		float dy = target._y - y[i];
+		float dist2 = dx * dx + dy * dy;
+		float reach = r[i] + target_radius;
+		float scale = speed[i] / std::sqrt(std::max(dist2, 1e-6f));
+		scale = (dist2 >= reach * reach) ? scale : 0.0f;
+		vx[i] = dx * scale;
+		vy[i] = dy * scale;
 	}
-	else if (_type == PRIEST) {
-		_radius = 30.0f;
-		_hp = 40.0f;
-		_max_hp = _hp;
-		_speed = 100.0f;
-		_dammage = 20.0f;
-		_shoot_cooldown = 2.0f; // tire toutes les 2 secondes
+}
+
+// Update parallèle : chaque worker traite des morceaux de [0, size()) et écrit
+// ses projectiles dans son propre tampon, fusionnés ensuite par ordre d'ennemi.
+// Le résultat est identique quel que soit le nombre de threads.
+void	EntityStore::update(float dt, const Player& player, const Room& room, const FlowField& flow,
+			ProjectilePool& projectiles, JobSystem& jobs, std::pmr::memory_resource* frame) {
+	size_t workers = (size_t)jobs.worker_count();
+	if (_spawn_buffers.size() < workers)
+		_spawn_buffers.resize(workers);
+	// Un tireur tire au plus une fois par tick : avec cette capacité, les
+	// tampons ne grossissent plus pendant l'update. Ils suivent la capacité
+	// du store (réservée par vague) plutôt que chaque nouveau tireur.
+	size_t shooters = 0;
+	for (int a = 0; a < ENTITY_ARCHETYPE_COUNT; ++a) {
+		if (ARCHETYPE_SHOOTS[a])
+			shooters += type_end(a) - type_begin(a);
 	}
-	else {
-		_radius = 12.0f;
-		_hp = 30.0f;
-		_max_hp = _hp;
-		_speed = 150.0f;
-		_dammage = 10.0f;
-		_shoot_cooldown = 0;
+	for (auto& buffer : _spawn_buffers) {
+		buffer.clear();
+		if (buffer.capacity() < shooters)
+			buffer.reserve(capacity());
 	}
+
+	auto job = [&](size_t begin, size_t end, int worker) {
+		PROFILE_ZONE("enemy_chunk");
+		update_range(begin, end, dt, player, room, flow, _spawn_buffers[worker]);
+	};
+	jobs.parallel_for(0, size(), ENEMY_UPDATE_GRAIN, job);
+
+	// Fusion déterministe (un ennemi tire au plus une fois par tick), dans
+	// l'arène du tick
+	size_t total = 0;
+	for (size_t w = 0; w < workers; ++w)
+		total += _spawn_buffers[w].size();
+	std::pmr::vector<SpawnedProjectile> merged(frame);
+	merged.reserve(total);
+	for (size_t w = 0; w < workers; ++w)
+		merged.insert(merged.end(), _spawn_buffers[w].begin(), _spawn_buffers[w].end());
+	std::sort(merged.begin(), merged.end(), [](const SpawnedProjectile& a, const SpawnedProjectile& b) {
+		return a._source < b._source;
+	});
+	for (const auto& spawned : merged)
+		projectiles.spawn(spawned._projectile);
 }
 
-void	Entity::update(float dt, const Player& player, const Room& room, std::vector<Projectile>& projectiles) {
-	if (!_alive)
-		return;
-	
-	// Priest tire des projectiles vers le joueur
-	if (_type == PRIEST && _shoot_cooldown > 0) {
-		_shoot_timer += dt;
-		if (_shoot_timer >= _shoot_cooldown) {
-			_shoot_timer = 0;
-			Vector2f dir = (player._pos - _pos).normalized();
-			Vector2f proj_vel = dir * 250.0f;
-			projectiles.emplace_back(_pos + dir * _radius, proj_vel, _dammage * 0.5f, 6.0f, false, 3.0f);
+// Update d'un lot d'ennemis du même archétype : aucune branche sur le type
+template <int Archetype>
+static void	update_batch(EntityStore& s, size_t begin, size_t end, float dt, const Player& player,
+				const Room& room, const FlowField& flow, std::vector<SpawnedProjectile>& spawns) {
+	if (EnemyBehavior<Archetype>::SHOOTS) {
+		const EntityArchetype& a = archetypes().entity(Archetype);
+		for (size_t i = begin; i < end; ++i) {
+			s._shoot_timer[i] += dt;
+			// Cadence nulle (archetypes.txt) : ce tireur ne tire pas
+			if (!s._alive[i] || s._shoot_cooldown[i] <= 0 || s._shoot_timer[i] < s._shoot_cooldown[i])
+				continue;
+			s._shoot_timer[i] = 0;
+			Vector2f dir = (player._pos - s.pos(i)).normalized();
+			Vector2f proj_vel = dir * a._shot_speed;
+			spawns.push_back({(uint32_t)i, Projectile(s.pos(i) + dir * s._radius[i], proj_vel,
+				s._dammage[i] * a._shot_damage_scale, a._shot_radius, false, a._shot_lifetime)});
 		}
 	}
-	
-	// Se diriger vers le joueur seulement si pas déjà en collision
-	if (aabb_collision(_pos, _radius, player._pos, player._radius))
-		return;
-	
-	Vector2f dir = (player._pos - _pos).normalized();
-	Vector2f next_pos = _pos + (dir * _speed * dt);
-	if (room.is_walkable(next_pos, _radius)) {
-		_pos = next_pos;
+
+	// Direction vers le joueur (vitesse nulle si déjà en collision avec le joueur)
+	steer_towards(end - begin, &s._pos_x[begin], &s._pos_y[begin], &s._radius[begin], &s._speed[begin],
+		&s._vel_x[begin], &s._vel_y[begin], player._pos, player._radius);
+
+	// Plus loin qu'une tuile : on suit le flow field vers le centre de la tuile
+	// suivante, ce qui contourne les piliers au lieu de buter dessus
+	for (size_t i = begin; i < end; ++i) {
+		int tile = flow.tile_at(s.pos(i));
+		if (!s._alive[i] || flow.distance(tile) <= 1 || flow.distance(tile) == INT32_MAX || flow._next[tile] < 0)
+			continue;
+		Vector2f dir = (flow.tile_center(flow._next[tile]) - s.pos(i)).normalized();
+		s._vel_x[i] = dir._x * s._speed[i];
+		s._vel_y[i] = dir._y * s._speed[i];
+	}
+
+	// Déplacement validé contre les murs de la salle ; si bloqué, on glisse le
+	// long du mur sur l'axe qui reste libre
+	for (size_t i = begin; i < end; ++i) {
+		if (!s._alive[i] || (s._vel_x[i] == 0 && s._vel_y[i] == 0))
+			continue;
+		Vector2f next_pos(s._pos_x[i] + s._vel_x[i] * dt, s._pos_y[i] + s._vel_y[i] * dt);
+		Vector2f slide_x(next_pos._x, s._pos_y[i]);
+		Vector2f slide_y(s._pos_x[i], next_pos._y);
+		if (room.is_walkable(next_pos, s._radius[i]))
+			s.set_pos(i, next_pos);
+		else if (s._vel_x[i] != 0 && room.is_walkable(slide_x, s._radius[i]))
+			s.set_pos(i, slide_x);
+		else if (s._vel_y[i] != 0 && room.is_walkable(slide_y, s._radius[i]))
+			s.set_pos(i, slide_y);
+	}
+}
+
+typedef void	(*UpdateKernel)(EntityStore& s, size_t begin, size_t end, float dt, const Player& player,
+					const Room& room, const FlowField& flow, std::vector<SpawnedProjectile>& spawns);
+
+static const UpdateKernel	UPDATE_KERNELS[] = {
+	update_batch<Entity::SKELETON>,
+	update_batch<Entity::VAMPIRE>,
+	update_batch<Entity::PRIEST>,
+	update_batch<Entity::UNKNOWN>,
+};
+
+static_assert(sizeof(UPDATE_KERNELS) / sizeof(UPDATE_KERNELS[0]) == ENTITY_ARCHETYPE_COUNT,
+	"un kernel d'update par archétype");
+
+// [begin, end) est découpé selon les groupes d'archétypes : un appel de kernel par lot
+void	EntityStore::update_range(size_t begin, size_t end, float dt, const Player& player, const Room& room,
+			const FlowField& flow, std::vector<SpawnedProjectile>& spawns) {
+	for (int a = 0; a < ENTITY_ARCHETYPE_COUNT; ++a) {
+		size_t batch_begin = std::max(begin, type_begin(a));
+		size_t batch_end = std::min(end, type_end(a));
+		if (batch_begin < batch_end)
+			UPDATE_KERNELS[a](*this, batch_begin, batch_end, dt, player, room, flow, spawns);
 	}
 }
 
-void	Entity::draw() const {
-	if (!_alive)
-		return;
-	
-	Color entity_color = WHITE;
-	if (_type == SKELETON)
-		entity_color = GRAY;
-	if (_type == VAMPIRE)
-		entity_color = RED;
-	if (_type == PRIEST)
-		entity_color = GREEN;
-	
-	DrawCircleV({_pos._x, _pos._y}, _radius, entity_color);
-	
+// Seuls les ennemis des cellules visibles sont dessinés. grid est construite
+// sur les positions courantes : view est élargie de VIEW_CULL_MARGIN pour
+// l'interpolation et les barres de vie. Avec l'atlas chargé, chaque archétype
+// est dessiné par son animation (time : temps de jeu), sinon par un cercle.
+// Les corps passent avant les barres de vie : les sprites s'enchaînent sur la
+// même page sans alterner avec la texture des formes.
+void	EntityStore::draw(float alpha, float time, const SpatialGrid& grid, const Rectangle& view) const {
+	Vector2f lo(view.x - VIEW_CULL_MARGIN, view.y - VIEW_CULL_MARGIN);
+	Vector2f hi(view.x + view.width + VIEW_CULL_MARGIN, view.y + view.height + VIEW_CULL_MARGIN);
+	Rectangle margin_view = {lo._x, lo._y, hi._x - lo._x, hi._y - lo._y};
+	// Appelle fn(i, position interpolée) pour chaque ennemi visible. Les cellules
+	// du bord rangent aussi les ennemis hors salle : test exact.
+	auto for_each_visible = [&](auto fn) {
+		grid.for_each_in_rect(lo, hi, [&](int i) {
+			if (circle_in_rect(pos(i), _radius[i], margin_view))
+				fn(i, Vector2f(_prev_x[i] + (_pos_x[i] - _prev_x[i]) * alpha,
+					_prev_y[i] + (_pos_y[i] - _prev_y[i]) * alpha));
+		});
+	};
+
+	const SpriteAtlas& atlas = sprite_atlas();
+	const int* first = atlas._entity_first;
+	const int* count = atlas._entity_count;
+	int step = (int)(time * SPRITE_ANIMATION_FPS);
+
+	for_each_visible([&](int i, const Vector2f& p) {
+		int a = _archetype[i];
+		if (count[a] == 0) {
+			DrawCircleV({p._x, p._y}, _radius[i], archetypes().entity(a)._color);
+			render_stats()._draw_calls++;
+			return;
+		}
+		// Désynchronisées par ennemi pour que la foule ne batte pas à l'unisson
+		int frame = first[a] + (step + i) % count[a];
+		atlas.draw(frame, p, _radius[i] * 2.0f / atlas._frames[frame]._source_width, WHITE);
+	});
+
 	// Barre de vie au-dessus de l'ennemi
-	float bar_width = _radius * 2.0f;
-	float bar_height = 4.0f;
-	float bar_x = _pos._x - bar_width * 0.5f;
-	float bar_y = _pos._y - _radius - 10.0f;
-	float hp_ratio = _hp / _max_hp;
-	DrawRectangle((int)bar_x, (int)bar_y, (int)bar_width, (int)bar_height, DARKGRAY);
-	DrawRectangle((int)bar_x, (int)bar_y, (int)(bar_width * hp_ratio), (int)bar_height, 
-		hp_ratio > 0.5f ? GREEN : (hp_ratio > 0.25f ? YELLOW : RED));
+	for_each_visible([&](int i, const Vector2f& p) {
+		float radius = _radius[i];
+		float bar_width = radius * 2.0f;
+		float bar_height = 4.0f;
+		float bar_x = p._x - bar_width * 0.5f;
+		float bar_y = p._y - radius - 10.0f;
+		float hp_ratio = _hp[i] / _max_hp[i];
+		DrawRectangle((int)bar_x, (int)bar_y, (int)bar_width, (int)bar_height, DARKGRAY);
+		DrawRectangle((int)bar_x, (int)bar_y, (int)(bar_width * hp_ratio), (int)bar_height, 
+			hp_ratio > 0.5f ? GREEN : (hp_ratio > 0.25f ? YELLOW : RED));
+		render_stats()._draw_calls += 2;
+	});
 }
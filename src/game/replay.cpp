@@ -0,0 +1,167 @@
+#include "game.h"
+#include <cstring>
+
+// ============================================================================
+// INPUT RECORDER
+// ============================================================================
+
+// Drapeaux d'un tick : boutons, et vecteurs ayant changé depuis `last`
+static uint8_t	replay_flags(const InputState& input, const InputState& last) {
+	uint8_t flags = 0;
+	if (input._dash) flags |= REPLAY_DASH;
+	if (input._attack) flags |= REPLAY_ATTACK;
+	if (input._weapon_1) flags |= REPLAY_WEAPON_1;
+	if (input._weapon_2) flags |= REPLAY_WEAPON_2;
+	if (input._switch_weapon) flags |= REPLAY_SWITCH_WEAPON;
+	if (input._restart) flags |= REPLAY_RESTART;
+	// Comparaison bit à bit : un replay doit retrouver exactement les mêmes floats
+	if (std::memcmp(&input._move, &last._move, sizeof(Vector2f)) != 0) flags |= REPLAY_MOVE;
+	if (std::memcmp(&input._aim, &last._aim, sizeof(Vector2f)) != 0) flags |= REPLAY_AIM;
+	return flags;
+}
+
+InputRecorder::InputRecorder() : _ticks(0), _checksum_interval(REPLAY_CHECKSUM_INTERVAL) {}
+
+// À ouvrir avant Game::init() : l'en-tête garde la graine courante de game._rng
+bool	InputRecorder::open(const std::string& file, const Game& game, int checksum_interval) {
+	_out.open(file, std::ios::binary | std::ios::trunc);
+	if (!_out) {
+		printf("ERROR: Cannot write replay file %s\n", file.c_str());
+		return false;
+	}
+	_file = file;
+	_last = InputState();
+	_ticks = 0;
+	_checksum_interval = (uint32_t)std::max(checksum_interval, 1);
+
+	ReplayHeader header;
+	std::memcpy(header._magic, REPLAY_MAGIC, 4);
+	header._version = REPLAY_VERSION;
+	header._tick_rate = (uint16_t)game._tick_rate;
+	header._seed = game._rng._seed;
+	header._checksum_interval = _checksum_interval;
+	_out.write((const char*)&header, sizeof(header));
+	return true;
+}
+
+// Appelé à la fin de Game::tick avec l'input de ce tick
+void	InputRecorder::record(const InputState& input, const Game& game) {
+	if (!_out.is_open())
+		return;
+	uint8_t flags = replay_flags(input, _last);
+	_out.put((char)flags);
+	if (flags & REPLAY_MOVE)
+		_out.write((const char*)&input._move, sizeof(Vector2f));
+	if (flags & REPLAY_AIM)
+		_out.write((const char*)&input._aim, sizeof(Vector2f));
+	_last = input;
+
+	if (++_ticks % _checksum_interval == 0) {
+		uint64_t checksum = game.checksum();
+		_out.write((const char*)&checksum, sizeof(checksum));
+	}
+}
+
+void	InputRecorder::close() {
+	if (!_out.is_open())
+		return;
+	_out.close();
+	printf("DEBUG: Recorded %u ticks to %s\n", _ticks, _file.c_str());
+}
+
+// ============================================================================
+// REPLAY INPUT
+// ============================================================================
+
+ReplayInput::ReplayInput()
+	:	_cursor(0),
+		_header(),
+		_ticks(0),
+		_pending(false),
+		_expected(0),
+		_checked(0),
+		_divergences(0),
+		_first_divergence(-1) {}
+
+bool	ReplayInput::load(const std::string& file) {
+	std::ifstream in(file, std::ios::binary);
+	if (!in) {
+		printf("ERROR: Failed to load replay file: %s\n", file.c_str());
+		return false;
+	}
+	_data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	if (_data.size() < sizeof(_header)) {
+		printf("ERROR: Failed to load replay file: %s (truncated header)\n", file.c_str());
+		return false;
+	}
+	std::memcpy(&_header, _data.data(), sizeof(_header));
+	if (std::memcmp(_header._magic, REPLAY_MAGIC, 4) != 0 || _header._version != REPLAY_VERSION
+		|| _header._tick_rate == 0 || _header._checksum_interval == 0) {
+		printf("ERROR: Failed to load replay file: %s (bad magic or version)\n", file.c_str());
+		return false;
+	}
+	_cursor = sizeof(_header);
+	_last = InputState();
+	_ticks = 0;
+	_pending = false;
+	_checked = 0;
+	_divergences = 0;
+	_first_divergence = -1;
+	return true;
+}
+
+// Compare le checksum en attente à l'état de la partie (après le tick _ticks)
+void	ReplayInput::verify(const Game& game) {
+	if (!_pending)
+		return;
+	_pending = false;
+	++_checked;
+	if (game.checksum() == _expected)
+		return;
+	if (_divergences++ == 0) {
+		_first_divergence = _ticks;
+		printf("WARNING: Replay diverged at tick %u\n", _ticks);
+	}
+}
+
+void	ReplayInput::poll(const Game& game, InputState& out) {
+	verify(game);
+	if (done()) {
+		// Fin de l'enregistrement : l'état maintenu reste, plus aucun appui
+		out = _last;
+		out.clear_edges();
+		return;
+	}
+
+	uint8_t flags = _data[_cursor++];
+	size_t need = ((flags & REPLAY_MOVE) ? sizeof(Vector2f) : 0) + ((flags & REPLAY_AIM) ? sizeof(Vector2f) : 0);
+	if (_cursor + need > _data.size()) {
+		printf("WARNING: Replay truncated at tick %u\n", _ticks);
+		_cursor = _data.size();
+		out = _last;
+		out.clear_edges();
+		return;
+	}
+	out = _last;
+	out._dash = (flags & REPLAY_DASH) != 0;
+	out._attack = (flags & REPLAY_ATTACK) != 0;
+	out._weapon_1 = (flags & REPLAY_WEAPON_1) != 0;
+	out._weapon_2 = (flags & REPLAY_WEAPON_2) != 0;
+	out._switch_weapon = (flags & REPLAY_SWITCH_WEAPON) != 0;
+	out._restart = (flags & REPLAY_RESTART) != 0;
+	if (flags & REPLAY_MOVE) {
+		std::memcpy(&out._move, &_data[_cursor], sizeof(Vector2f));
+		_cursor += sizeof(Vector2f);
+	}
+	if (flags & REPLAY_AIM) {
+		std::memcpy(&out._aim, &_data[_cursor], sizeof(Vector2f));
+		_cursor += sizeof(Vector2f);
+	}
+	_last = out;
+
+	if (++_ticks % _header._checksum_interval == 0 && _cursor + sizeof(_expected) <= _data.size()) {
+		std::memcpy(&_expected, &_data[_cursor], sizeof(_expected));
+		_cursor += sizeof(_expected);
+		_pending = true;
+	}
+}
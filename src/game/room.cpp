@@ -1,25 +1,56 @@
 #include "game.h"
+#include <sys/stat.h>
+#include <cstring>
+
+static bool	file_exists(const std::string& path) {
+	struct stat st;
+	return stat(path.c_str(), &st) == 0;
+}
+
+static bool	has_suffix(const std::string& s, const std::string& suffix) {
+	return s.length() > suffix.length() && s.compare(s.length() - suffix.length(), suffix.length(), suffix) == 0;
+}
 
 // ============================================================================
-// ROOM
+// ROOM TEMPLATE
 // ============================================================================
 
-Room::Room() : _width(0), _height(0), _tile_size(32), _room_id(-1), _world_offset(0, 0) {}
+RoomTemplate::RoomTemplate() : _width(0), _height(0) {}
 
-Room::Room(int w, int h, int tile_size) 
-	: _width(w), _height(h), _tile_size(tile_size), _room_id(-1), _world_offset(0, 0) {
-	_tiles.assign(w * h, WALL);
+// Choisit le format d'après l'extension (.roomb binaire, sinon texte)
+bool RoomTemplate::load(const std::string& filename, std::pmr::memory_resource* scratch) {
+	_file = filename;
+	bool ok = has_suffix(filename, ROOM_BINARY_EXT) ? load_binary(filename) : load_text(filename, scratch);
+	if (ok)
+		_analysis.build(_tiles, scratch);
+	return ok;
 }
 
-bool Room::load_from_file(const std::string& filename, int tile_size) {
+// Template construit en mémoire (Room(w, h), édition) : tuiles découpées en
+// chunks puis analysées
+void RoomTemplate::assign(int width, int height, const uint8_t* tiles) {
+	_store.assign(width, height, tiles);
+	use_store();
+}
+
+// Les tuiles viennent de _store (rempli ou modifié par l'appelant) : vue et analyse
+void RoomTemplate::use_store(std::pmr::memory_resource* scratch) {
+	_mapping.close();
+	_width = _store._width;
+	_height = _store._height;
+	_tiles = _store.view();
+	_analysis.build(_tiles, scratch);
+}
+
+bool RoomTemplate::load_text(const std::string& filename, std::pmr::memory_resource* scratch) {
 	std::ifstream file(filename);
 	if (!file.is_open()) {
 		printf("ERROR : Failed to load room file: %s\n", filename.c_str());
 		return false;
 	}
 
-	std::vector<std::string> lines;
-	std::string line;
+	std::pmr::vector<std::pmr::string> lines(scratch);
+	std::pmr::string line(scratch);
 	while (std::getline(file, line)) {
 		if (line.empty() || line[0] == ' ') {
 			printf("ERROR : Failed to load room file: %s\n", filename.c_str());
@@ -36,98 +67,360 @@ bool Room::load_from_file(const std::string& filename, int tile_size) {
 
 	_height = lines.size();
 	_width = lines[0].length();
-	_tile_size = tile_size;
-	_tiles.assign(_width * _height, WALL);
+	// Grille ligne par ligne dans le brouillon, puis découpée en chunks
+	std::pmr::vector<uint8_t> tiles((size_t)_width * _height, Room::WALL, scratch);
 
+	// Comme l'ancien set_tile : une ligne plus longue que la première est
+	// tronquée, une plus courte complétée par des murs
 	for (int y = 0; y < _height; ++y) {
-		for (int x = 0; x < (int)lines[y].length(); ++x) {
+		int row_width = std::min((int)lines[y].length(), _width);
+		for (int x = 0; x < row_width; ++x) {
 			char c = lines[y][x];
-			Tile t = WALL;
+			Room::Tile t = Room::WALL;
 			if (c == '.')
-				t = FLOOR;
+				t = Room::FLOOR;
 			else if (c == 'N')
-				t = DOOR_N;
+				t = Room::DOOR_N;
 			else if (c == 'S')
-				t = DOOR_S;
+				t = Room::DOOR_S;
 			else if (c == 'E')
-				t = DOOR_E;
+				t = Room::DOOR_E;
 			else if (c == 'O')
-				t = DOOR_O;
-			set_tile(x, y, t);
+				t = Room::DOOR_O;
+			tiles[y * _width + x] = (uint8_t)t;
+		}
+	}
+	_store.assign(_width, _height, tiles.data());
+	_tiles = _store.view();
+	return true;
+}
+
+// Projette le fichier et pointe directement sur ses chunks : aucune copie ni
+// décodage, le coût ne dépend plus de la taille de la salle
+bool RoomTemplate::load_binary(const std::string& filename) {
+	if (!_mapping.open(filename)) {
+		printf("ERROR : Failed to load room file: %s\n", filename.c_str());
+		return false;
+	}
+
+	RoomFileHeader header;
+	if (_mapping._size < sizeof(header)) {
+		printf("ERROR : Failed to load room file: %s (truncated header)\n", filename.c_str());
+		return false;
+	}
+	std::memcpy(&header, _mapping._data, sizeof(header));
+	if (std::memcmp(header._magic, ROOM_BINARY_MAGIC, 4) != 0 || header._version != ROOM_BINARY_VERSION) {
+		printf("ERROR : Failed to load room file: %s (bad magic or version)\n", filename.c_str());
+		return false;
+	}
+	uint64_t chunks_x = ((uint64_t)header._width + TILE_CHUNK_MASK) >> TILE_CHUNK_SHIFT;
+	uint64_t chunks_y = ((uint64_t)header._height + TILE_CHUNK_MASK) >> TILE_CHUNK_SHIFT;
+	uint64_t chunk_count = chunks_x * chunks_y;
+	uint64_t blocks_offset = (uint64_t)header._tiles_offset + chunk_count * (sizeof(uint32_t) + 1);
+	if (chunk_count == 0 || header._width > INT32_MAX || header._height > INT32_MAX || header._tiles_offset % 4 != 0
+		|| header._block_count > chunk_count
+		|| blocks_offset + (uint64_t)header._block_count * TILE_CHUNK_AREA + header._meta_size > _mapping._size) {
+		printf("ERROR : Failed to load room file: %s (bad dimensions)\n", filename.c_str());
+		return false;
+	}
+	const uint32_t* block = (const uint32_t*)(_mapping._data + header._tiles_offset);
+	for (uint64_t c = 0; c < chunk_count; ++c) {
+		if (block[c] != TILE_CHUNK_UNIFORM && block[c] >= header._block_count) {
+			printf("ERROR : Failed to load room file: %s (bad chunk table)\n", filename.c_str());
+			return false;
 		}
 	}
 
+	_width = (int)header._width;
+	_height = (int)header._height;
+	_tiles._width = _width;
+	_tiles._height = _height;
+	_tiles._chunks_x = (int)chunks_x;
+	_tiles._chunks_y = (int)chunks_y;
+	_tiles._block = block;
+	_tiles._value = _mapping._data + header._tiles_offset + chunk_count * sizeof(uint32_t);
+	_tiles._blocks = _mapping._data + blocks_offset;
+	_tiles._block_count = header._block_count;
 	return true;
 }
 
+bool RoomTemplate::save_binary(const std::string& filename, const std::string& meta) const {
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		printf("ERROR : Failed to write room file: %s\n", filename.c_str());
+		return false;
+	}
+
+	RoomFileHeader header;
+	std::memcpy(header._magic, ROOM_BINARY_MAGIC, 4);
+	header._version = ROOM_BINARY_VERSION;
+	header._flags = 0;
+	header._width = (uint32_t)_width;
+	header._height = (uint32_t)_height;
+	header._tiles_offset = sizeof(header);
+	header._block_count = (uint32_t)_tiles._block_count;
+	header._meta_size = (uint32_t)meta.size();
+	header._reserved = 0;
+
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)_tiles._block, (std::streamsize)(_tiles.chunk_count() * sizeof(uint32_t)));
+	file.write((const char*)_tiles._value, (std::streamsize)_tiles.chunk_count());
+	file.write((const char*)_tiles._blocks, (std::streamsize)(_tiles._block_count * TILE_CHUNK_AREA));
+	file.write(meta.data(), (std::streamsize)meta.size());
+	return file.good();
+}
+
+// ============================================================================
+// ROOM
+// ============================================================================
+
+Room::Room()
+	:	_width(0), _height(0), _tile_size(32), _inv_tile_size(1.0f / 32), _tiles(nullptr),
+		_room_id(-1), _world_offset(0, 0) {}
+
+Room::Room(int w, int h, int tile_size) 
+	:	_width(0), _height(0), _tile_size(tile_size), _inv_tile_size(1.0f / std::max(tile_size, 1)),
+		_tiles(nullptr), _room_id(-1), _world_offset(0, 0) {
+	std::vector<uint8_t> walls(w * h, WALL);
+	std::shared_ptr<RoomTemplate> tpl = std::make_shared<RoomTemplate>();
+	tpl->assign(w, h, walls.data());
+	bind(std::move(tpl), tile_size);
+}
+
+bool Room::load_from_file(const std::string& filename, int tile_size) {
+	std::shared_ptr<RoomTemplate> tpl = std::make_shared<RoomTemplate>();
+	if (!tpl->load(filename))
+		return false;
+	bind(std::move(tpl), tile_size);
+	return true;
+}
+
+// Fait pointer la Room sur un template : ni copie des tuiles ni allocation
+void Room::bind(std::shared_ptr<const RoomTemplate> tpl, int tile_size) {
+	_template = std::move(tpl);
+	_tiles = &_template->_tiles;
+	_width = _template->_width;
+	_height = _template->_height;
+	_tile_size = tile_size;
+	_inv_tile_size = 1.0f / std::max(tile_size, 1);
+}
+
+const RoomAnalysis& Room::analysis() const {
+	static const RoomAnalysis empty;
+	return _template ? _template->_analysis : empty;
+}
+
 Room::Tile Room::get_tile(int x, int y) const {
 	if (!in_bounds(x, y))
 		return WALL;
-	return (Tile)_tiles[y * _width + x];
+	return (Tile)_tiles->get(x, y);
 }
 
+// Copie à l'écriture des chunks dans un template privé (le partagé reste
+// immuable), puis nouvelle analyse : O(taille de la salle), réservé à l'édition
 void Room::set_tile(int x, int y, Tile t) {
 	if (!in_bounds(x, y))
 		return;
-	_tiles[y * _width + x] = (int)t;
+	std::shared_ptr<RoomTemplate> copy = std::make_shared<RoomTemplate>();
+	copy->_file = _template->_file;
+	copy->_store.copy(*_tiles);
+	copy->_store.set(x, y, (uint8_t)t);
+	copy->use_store();
+	bind(std::move(copy), _tile_size);
 }
 
 bool Room::in_bounds(int x, int y) const {
 	return x >= 0 && y >= 0 && x < _width && y < _height;
 }
 
+Vector2f Room::tile_center(int index) const {
+	int x = index % _width;
+	int y = index / _width;
+	return _world_offset + Vector2f((x + 0.5f) * _tile_size, (y + 0.5f) * _tile_size);
+}
+
 Vector2f Room::get_spawn() const {
-	for (int y = 0; y < _height; ++y) {
-		for (int x = 0; x < _width; ++x) {
-			Tile t = get_tile(x, y);
-			if (t == FLOOR || t == DOOR_N || t == DOOR_S || t == DOOR_E || t == DOOR_O) {
-				return _world_offset + Vector2f((x + 0.5f) * _tile_size, (y + 0.5f) * _tile_size);
-			}
-		}
-	}
+	int first = analysis()._first_open;
+	if (first >= 0)
+		return tile_center(first);
 	return _world_offset + Vector2f(_width * _tile_size * 0.5f, _height * _tile_size * 0.5f);
 }
 
 Vector2f Room::get_door_position(Tile door_type) const {
-	for (int y = 0; y < _height; ++y) {
-		for (int x = 0; x < _width; ++x) {
-			if (get_tile(x, y) == door_type) {
-				float px = _world_offset._x + (x + 0.5f) * _tile_size;
-				float py = _world_offset._y + (y + 0.5f) * _tile_size;
-				// Décaler légèrement vers l'intérieur pour éviter de re-trigger la transition
-				if (door_type == DOOR_N) py += _tile_size;
-				else if (door_type == DOOR_S) py -= _tile_size;
-				else if (door_type == DOOR_E) px -= _tile_size;
-				else if (door_type == DOOR_O) px += _tile_size;
-				return Vector2f(px, py);
+	if (door_type < DOOR_N || door_type > DOOR_O)
+		return Vector2f(-1, -1);
+	const std::vector<int>& doors = analysis()._doors[RoomAnalysis::door_index(door_type)];
+	if (doors.empty())
+		return Vector2f(-1, -1);
+
+	Vector2f pos = tile_center(doors[0]);
+	// Décaler légèrement vers l'intérieur pour éviter de re-trigger la transition
+	if (door_type == DOOR_N) pos._y += _tile_size;
+	else if (door_type == DOOR_S) pos._y -= _tile_size;
+	else if (door_type == DOOR_E) pos._x -= _tile_size;
+	else if (door_type == DOOR_O) pos._x += _tile_size;
+	return pos;
+}
+
+// Composante de la tuile sous pos (-1 si mur ou hors salle)
+int Room::component_at(const Vector2f& pos) const {
+	Vector2f local_pos = pos - _world_offset;
+	int x = (int)std::floor(local_pos._x / _tile_size);
+	int y = (int)std::floor(local_pos._y / _tile_size);
+	if (!in_bounds(x, y))
+		return -1;
+	return analysis()._component[y * _width + x];
+}
+
+int Room::door_component(Tile door_type) const {
+	if (door_type < DOOR_N || door_type > DOOR_O)
+		return -1;
+	const std::vector<int>& doors = analysis()._doors[RoomAnalysis::door_index(door_type)];
+	return doors.empty() ? -1 : analysis()._component[doors[0]];
+}
+
+int Room::clearance_at(int x, int y) const {
+	return in_bounds(x, y) ? analysis()._clearance[y * _width + x] : 0;
+}
+
+// Tuiles FLOOR de la composante où un cercle de ce rayon tient sans toucher de
+// mur : first pointe sur la première, renvoie leur nombre. Les candidats d'une
+// composante étant triés par dégagement décroissant, ceux qui conviennent
+// forment un préfixe.
+int Room::spawn_candidates(float radius, int component, const int*& first) const {
+	const RoomAnalysis& a = analysis();
+	first = nullptr;
+	if (component < 0 || component >= a._component_count)
+		return 0;
+	// Dégagement d (tuiles) : d - 0.5 tuile libre autour du centre
+	int needed = std::max(1, (int)std::ceil(radius / _tile_size + 0.5f));
+	const int* begin = a._spawns.data() + a._component_spawns[component];
+	const int* last = a._spawns.data() + a._component_spawns[component + 1];
+	const int* end = std::partition_point(begin, last, [&](int tile) { return a._clearance[tile] >= needed; });
+	first = begin;
+	return (int)(end - begin);
+}
+
+// Tire un centre de tuile parmi spawn_candidates()
+bool Room::random_spawn_point(float radius, int component, Rng& rng, Vector2f& out) const {
+	const int* first;
+	int count = spawn_candidates(radius, component, first);
+	if (count == 0)
+		return false;
+	out = tile_center(first[rng.range(0, count - 1)]);
+	return true;
+}
+
+// Cercle contre les murs, exact quel que soit le rayon. Le champ de dégagement
+// accepte d'emblée la plupart des cas ; sinon seules les tuiles mur de la
+// boîte englobante (bits du masque) sont testées contre le cercle.
+bool Room::is_walkable(const Vector2f& pos, float radius) const {
+	// En unités de tuile
+	float lx = (pos._x - _world_offset._x) * _inv_tile_size;
+	float ly = (pos._y - _world_offset._y) * _inv_tile_size;
+	float lr = radius * _inv_tile_size;
+	if (lx - lr < 0 || ly - lr < 0 || lx + lr >= _width || ly + lr >= _height)
+		return false;
+
+	const RoomAnalysis& a = analysis();
+	int cx = (int)lx;
+	int cy = (int)ly;
+	int clearance = a._clearance[cy * _width + cx];
+	if (clearance == 0)
+		return false;
+	// Tout mur est à au moins clearance - 1 tuiles (en x ou en y) de la tuile du centre
+	if (lr <= clearance - 1)
+		return true;
+
+	int x0 = (int)(lx - lr);
+	int x1 = (int)(lx + lr);
+	int y0 = (int)(ly - lr);
+	int y1 = (int)(ly + lr);
+	float lr2 = lr * lr;
+	for (int y = y0; y <= y1; ++y) {
+		float dy = std::max(std::max((float)y - ly, ly - (float)(y + 1)), 0.0f);
+		float dy2 = dy * dy;
+		if (dy2 >= lr2)
+			continue;
+		const uint64_t* row = &a._wall_mask[y * a._mask_stride];
+		for (int w = x0 >> 6; w <= (x1 >> 6); ++w) {
+			uint64_t bits = row[w];
+			// Restreint le mot aux colonnes [x0, x1]
+			int lo = std::max(x0 - (w << 6), 0);
+			int hi = std::min(x1 - (w << 6), 63);
+			bits &= (~0ULL << lo) & (~0ULL >> (63 - hi));
+			while (bits) {
+				int x = (w << 6) + __builtin_ctzll(bits);
+				bits &= bits - 1;
+				float dx = std::max(std::max((float)x - lx, lx - (float)(x + 1)), 0.0f);
+				if (dx * dx + dy2 < lr2)
+					return false;
 			}
 		}
 	}
-	return Vector2f(-1, -1);
+	return true;
 }
 
-bool Room::is_walkable(const Vector2f& pos, float radius) const {
-	Vector2f local_pos = pos - _world_offset;
-	int left = (int)std::floor((local_pos._x - radius) / _tile_size);
-	int right = (int)std::floor((local_pos._x + radius) / _tile_size);
-	int top = (int)std::floor((local_pos._y - radius) / _tile_size);
-	int bottom = (int)std::floor((local_pos._y + radius) / _tile_size);
-
-	if (!in_bounds(left, top) || !in_bounds(right, bottom))
+// Premier contact avec les murs d'un cercle allant de from à to (le bord de la
+// salle compte comme un mur). Seules les tuiles traversées par le centre (DDA)
+// sont visitées, avec les murs à portée du rayon autour de chacune : un contact
+// au temps t se trouve forcément autour de la tuile occupée à t, d'où l'arrêt
+// dès qu'on entre dans une tuile après le meilleur contact. t_hit ∈ [0, 1].
+bool Room::sweep_circle(const Vector2f& from, const Vector2f& to, float radius, float& t_hit) const {
+	Vector2f a = (from - _world_offset) * _inv_tile_size;
+	Vector2f b = (to - _world_offset) * _inv_tile_size;
+	float lr = radius * _inv_tile_size;
+	int reach = (int)std::ceil(lr);
+	const RoomAnalysis& an = analysis();
+	float best = 2.0f;
+	grid_traverse(a, b, [&](int cx, int cy, float t_enter) {
+		if (t_enter > best)
+			return false;
+		// Aucun mur à moins de `clearance` tuiles : rien à tester ici
+		if (in_bounds(cx, cy) && an._clearance[cy * _width + cx] > reach)
+			return true;
+		for (int y = cy - reach; y <= cy + reach; ++y) {
+			for (int x = cx - reach; x <= cx + reach; ++x) {
+				if (in_bounds(x, y) && !an.is_wall(x, y))
+					continue;
+				float t;
+				if (sweep_circle_box(a, b, lr, Vector2f((float)x, (float)y),
+						Vector2f((float)(x + 1), (float)(y + 1)), t) && t < best)
+					best = t;
+			}
+		}
+		return true;
+	});
+	if (best > 1.0f)
 		return false;
+	t_hit = best;
+	return true;
+}
 
-	Tile tl = get_tile(left, top);
-	Tile tr = get_tile(right, top);
-	Tile bl = get_tile(left, bottom);
-	Tile br = get_tile(right, bottom);
+// Tuiles [x0, x1) x [y0, y1) qui touchent le rectangle view (coordonnées monde),
+// bornées à la salle : vide si la vue est hors de la salle
+void Room::tile_range(const Rectangle& view, int& x0, int& y0, int& x1, int& y1) const {
+	float lx = (view.x - _world_offset._x) * _inv_tile_size;
+	float ly = (view.y - _world_offset._y) * _inv_tile_size;
+	x0 = std::max((int)std::floor(lx), 0);
+	y0 = std::max((int)std::floor(ly), 0);
+	x1 = std::min((int)std::ceil(lx + view.width * _inv_tile_size), _width);
+	y1 = std::min((int)std::ceil(ly + view.height * _inv_tile_size), _height);
+	x1 = std::max(x1, x0);
+	y1 = std::max(y1, y0);
+}
 
-	auto is_passable = [](Tile t) { return t != WALL; };
-	return is_passable(tl) && is_passable(tr) && is_passable(bl) && is_passable(br);
+void Room::draw(const Rectangle& view) const {
+	int x0, y0, x1, y1;
+	tile_range(view, x0, y0, x1, y1);
+	draw_tiles(_world_offset, x0, y0, x1, y1);
 }
 
-void Room::draw() const {
-	for (int y = 0; y < _height; ++y) {
-		for (int x = 0; x < _width; ++x) {
+// Une DrawRectangle par tuile de [x0, x1) x [y0, y1) : sert à la cuisson (salle
+// entière) et au chemin de secours (tuiles visibles)
+void Room::draw_tiles(const Vector2f& origin, int x0, int y0, int x1, int y1) const {
+	for (int y = y0; y < y1; ++y) {
+		for (int x = x0; x < x1; ++x) {
 			Tile t = get_tile(x, y);
 			Color color = {40, 40, 50, 255};
 			if (t == WALL)
@@ -135,166 +428,495 @@ void Room::draw() const {
 			else if (t == DOOR_N || t == DOOR_S || t == DOOR_E || t == DOOR_O)
 				color = {100, 100, 200, 255};
 
-			Vector2f pos = _world_offset + Vector2f(x * _tile_size, y * _tile_size);
+			Vector2f pos = origin + Vector2f(x * _tile_size, y * _tile_size);
 			DrawRectangle((int)pos._x, (int)pos._y, _tile_size, _tile_size, color);
 		}
 	}
+	int count = (x1 - x0) * (y1 - y0);
+	render_stats()._draw_calls += count;
+	render_stats()._tile_draw_calls += count;
+}
+
+// ============================================================================
+// ROOM ANALYSIS
+// ============================================================================
+
+RoomAnalysis::RoomAnalysis() : _first_open(-1), _mask_stride(0), _component_count(0) {}
+
+// Les chunks sont d'abord décodés ligne par ligne dans le brouillon : les
+// passes ci-dessous parcourent la salle entière dans cet ordre
+void RoomAnalysis::build(const TileChunks& chunks, std::pmr::memory_resource* scratch) {
+	int width = chunks._width;
+	int height = chunks._height;
+	int count = width * height;
+	std::pmr::vector<uint8_t> flat(count, scratch);
+	chunks.decode(flat.data());
+	const uint8_t* tiles = flat.data();
+	_first_open = -1;
+	for (int d = 0; d < 4; ++d)
+		_doors[d].clear();
+	for (int i = 0; i < count; ++i) {
+		Room::Tile t = (Room::Tile)tiles[i];
+		if (t != Room::WALL && _first_open < 0)
+			_first_open = i;
+		if (t >= Room::DOOR_N && t <= Room::DOOR_O)
+			_doors[door_index(t)].push_back(i);
+	}
+
+	// Dégagement : distance de Chebyshev au mur le plus proche (le bord compte
+	// comme un mur), en deux passes de chanfrein
+	_clearance.assign(count, 0);
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			int i = y * width + x;
+			if (tiles[i] == Room::WALL)
+				continue;
+			int d = 1;
+			if (x > 0 && y > 0 && x + 1 < width && y + 1 < height) {
+				d = std::min(std::min(_clearance[i - 1], _clearance[i - width - 1]),
+					std::min(_clearance[i - width], _clearance[i - width + 1])) + 1;
+			}
+			_clearance[i] = (uint8_t)std::min(d, 255);
+		}
+	}
+	for (int y = height - 2; y > 0; --y) {
+		for (int x = width - 2; x > 0; --x) {
+			int i = y * width + x;
+			if (tiles[i] == Room::WALL)
+				continue;
+			int d = std::min(std::min(_clearance[i + 1], _clearance[i + width - 1]),
+				std::min(_clearance[i + width], _clearance[i + width + 1])) + 1;
+			_clearance[i] = (uint8_t)std::min<int>(_clearance[i], d);
+		}
+	}
+
+	// Masque des murs, un bit par tuile
+	_mask_stride = (width + 63) / 64;
+	_wall_mask.assign((size_t)_mask_stride * height, 0);
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			if (tiles[y * width + x] == Room::WALL)
+				_wall_mask[y * _mask_stride + (x >> 6)] |= 1ULL << (x & 63);
+		}
+	}
+
+	// Composantes 4-connexes des tuiles praticables (portes comprises)
+	_component.assign(count, -1);
+	_component_count = 0;
+	std::pmr::vector<int> stack(scratch);
+	for (int start = 0; start < count; ++start) {
+		if (tiles[start] == Room::WALL || _component[start] >= 0)
+			continue;
+		int label = _component_count++;
+		_component[start] = label;
+		stack.push_back(start);
+		while (!stack.empty()) {
+			int i = stack.back();
+			stack.pop_back();
+			int x = i % width;
+			int neighbours[4] = {x > 0 ? i - 1 : -1, x + 1 < width ? i + 1 : -1, i - width, i + width};
+			for (int n : neighbours) {
+				if (n < 0 || n >= count || tiles[n] == Room::WALL || _component[n] >= 0)
+					continue;
+				_component[n] = label;
+				stack.push_back(n);
+			}
+		}
+	}
+
+	// Candidats de spawn : tuiles FLOOR, groupées par composante puis triées
+	// par dégagement décroissant (tri par comptage sur la composante)
+	_component_spawns.assign(_component_count + 1, 0);
+	for (int i = 0; i < count; ++i) {
+		if (tiles[i] == Room::FLOOR)
+			_component_spawns[_component[i] + 1]++;
+	}
+	for (int c = 0; c < _component_count; ++c)
+		_component_spawns[c + 1] += _component_spawns[c];
+	_spawns.assign(_component_spawns[_component_count], 0);
+	std::pmr::vector<int> cursor(_component_spawns.begin(), _component_spawns.end() - 1, scratch);
+	for (int i = 0; i < count; ++i) {
+		if (tiles[i] == Room::FLOOR)
+			_spawns[cursor[_component[i]]++] = i;
+	}
+	for (int c = 0; c < _component_count; ++c) {
+		std::stable_sort(_spawns.begin() + _component_spawns[c], _spawns.begin() + _component_spawns[c + 1],
+			[&](int a, int b) { return _clearance[a] > _clearance[b]; });
+	}
+}
+
+// ============================================================================
+// TILE LAYER
+// ============================================================================
+
+TileLayer::TileLayer() : _target(), _loaded(false), _dirty(true), _bakes(0) {}
+
+void TileLayer::invalidate() {
+	_dirty = true;
+}
+
+// Dessine toute la salle une fois dans la texture (coordonnées locales)
+bool TileLayer::bake(const Room& room) {
+	int width = room._width * room._tile_size;
+	int height = room._height * room._tile_size;
+	if (!IsWindowReady() || width <= 0 || height <= 0 || width > MAX_TILE_LAYER_SIZE
+		|| height > MAX_TILE_LAYER_SIZE)
+		return false;
+
+	// On garde la texture si la nouvelle salle a la même taille
+	if (_loaded && (_target.texture.width != width || _target.texture.height != height))
+		unload();
+	if (!_loaded) {
+		_target = LoadRenderTexture(width, height);
+		if (_target.id == 0) {
+			printf("WARNING: Could not create tile layer (%dx%d), drawing tiles directly\n", width, height);
+			return false;
+		}
+		_loaded = true;
+	}
+
+	RenderStats saved = render_stats();
+	BeginTextureMode(_target);
+	ClearBackground(BLANK);
+	room.draw_tiles(Vector2f(0, 0), 0, 0, room._width, room._height);
+	EndTextureMode();
+	render_stats() = saved;		// La cuisson n'est pas un coût par frame
+
+	_bakes++;
+	printf("DEBUG: Baked tile layer %dx%d for room %d (%d bakes)\n", width, height, room._room_id, _bakes);
+	return true;
+}
+
+void TileLayer::draw(const Room& room, const Rectangle& view) {
+	if (_dirty) {
+		_dirty = false;
+		if (!bake(room))
+			unload();
+	}
+	if (!_loaded) {
+		room.draw(view);
+		return;
+	}
+	int x0, y0, x1, y1;
+	room.tile_range(view, x0, y0, x1, y1);
+	if (x0 == x1 || y0 == y1)
+		return;
+	// Seule la partie visible est blittée. Les render textures sont stockées à
+	// l'envers (origine OpenGL en bas) : la ligne locale y est à height - y.
+	float ts = (float)room._tile_size;
+	Rectangle source = {x0 * ts, _target.texture.height - y1 * ts, (x1 - x0) * ts, -(y1 - y0) * ts};
+	DrawTextureRec(_target.texture, source,
+		{room._world_offset._x + x0 * ts, room._world_offset._y + y0 * ts}, WHITE);
+	render_stats()._draw_calls++;
+	render_stats()._tile_draw_calls++;
+}
+
+void TileLayer::unload() {
+	if (_loaded)
+		UnloadRenderTexture(_target);
+	_loaded = false;
+}
+
+// ============================================================================
+// ROOM CATALOG
+// ============================================================================
+
+const char*	room_category_name(int category) {
+	static const char* names[ROOM_CATEGORY_COUNT] = {"easy", "medium", "hard", "boss"};
+	return names[category];
+}
+
+RoomCatalog::RoomCatalog() : _available{0, 0, 0, 0}, _resets(0) {}
+
+void RoomCatalog::clear() {
+	_files.clear();
+	_category.clear();
+	_position.clear();
+	for (int c = 0; c < ROOM_CATEGORY_COUNT; ++c) {
+		_order[c].clear();
+		_available[c] = 0;
+	}
+	_ids.clear();
+	_resets = 0;
+}
+
+// Ajoute une salle non jouée ; un fichier déjà présent garde son id
+int RoomCatalog::add(const std::string& file, int category) {
+	int existing = find(file);
+	if (existing >= 0)
+		return existing;
+	int id = (int)_files.size();
+	std::vector<int>& order = _order[category];
+	_files.push_back(file);
+	_category.push_back((uint8_t)category);
+	_ids.emplace(file, id);
+
+	// Insérée à la fin de la partition "disponible" (la première jouée recule d'un cran)
+	int slot = _available[category];
+	order.push_back(id);
+	_position.push_back(slot);
+	if (slot != (int)order.size() - 1) {
+		order.back() = order[slot];
+		_position[order.back()] = (int)order.size() - 1;
+		order[slot] = id;
+	}
+	_available[category]++;
+	return id;
+}
+
+int RoomCatalog::find(const std::string& file) const {
+	auto it = _ids.find(file);
+	return it == _ids.end() ? -1 : it->second;
+}
+
+// Échange la salle avec la dernière disponible puis rétrécit la partition
+void RoomCatalog::mark_used(int id) {
+	if (is_used(id))
+		return;
+	std::vector<int>& order = _order[_category[id]];
+	int last = --_available[_category[id]];
+	int pos = _position[id];
+	int other = order[last];
+	order[pos] = other;
+	_position[other] = pos;
+	order[last] = id;
+	_position[id] = last;
+}
+
+void RoomCatalog::reset_used() {
+	for (int c = 0; c < ROOM_CATEGORY_COUNT; ++c)
+		_available[c] = (int)_order[c].size();
+	_resets++;
+}
+
+// Probabilités pondérées selon la progression du joueur
+// Plus le joueur avance, plus les salles hard/boss deviennent probables
+void RoomCatalog::weights(int rooms_visited, float out[ROOM_CATEGORY_COUNT]) const {
+	out[0] = _available[0] == 0 ? 0.0f : std::max(1.0f, 50.0f - rooms_visited * 5.0f);	// easy
+	out[1] = _available[1] == 0 ? 0.0f : std::max(1.0f, 30.0f - rooms_visited * 2.0f);	// medium
+	out[2] = _available[2] == 0 ? 0.0f : 15.0f + rooms_visited * 3.0f;					// hard
+	out[3] = _available[3] == 0 ? 0.0f : 5.0f + rooms_visited * 4.0f;					// boss
+}
+
+// Tirage pondéré de la catégorie puis uniforme parmi ses salles non jouées.
+// Ne marque pas la salle (fait à l'activation). Renvoie -1 si le catalogue est vide.
+int RoomCatalog::pick(int rooms_visited, Rng& rng, int* category) {
+	float w[ROOM_CATEGORY_COUNT];
+	weights(rooms_visited, w);
+	float total = w[0] + w[1] + w[2] + w[3];
+	if (total <= 0.0f) {
+		// Toutes les salles ont été visitées, on repart de zéro
+		if (_files.empty())
+			return -1;
+		reset_used();
+		weights(rooms_visited, w);
+		total = w[0] + w[1] + w[2] + w[3];
+	}
+
+	float roll = (float)rng.range(0, 10000) / 10000.0f * total;
+	int chosen = ROOM_CATEGORY_COUNT - 1;
+	float cumulative = 0.0f;
+	for (int c = 0; c < ROOM_CATEGORY_COUNT; ++c) {
+		cumulative += w[c];
+		if (roll < cumulative) {
+			chosen = c;
+			break;
+		}
+	}
+	// Arrondis flottants : ne jamais retomber sur une catégorie vide
+	while (_available[chosen] == 0)
+		chosen = (chosen + ROOM_CATEGORY_COUNT - 1) % ROOM_CATEGORY_COUNT;
+
+	if (category)
+		*category = chosen;
+	return _order[chosen][rng.range(0, _available[chosen] - 1)];
 }
 
 // ============================================================================
 // DUNGEON
 // ============================================================================
 
+const float	CAMERA_CATCHUP_RATE = 6.0f;	// Fraction de la distance restante couverte par seconde
+
 Dungeon::Dungeon() 
 	: _rooms_visited(0), _tile_size(64), _camera_target(0, 0), _camera_pos(0, 0), 
-	  _camera_transition_speed(500.0f), _transitioning(false) {}
+	  _camera_transition_speed(500.0f), _transitioning(false), _next_room(-1), _prefetch(&_templates), _rng(nullptr),
+	  _room_arena(ROOM_ARENA_SIZE) {}
 
 void Dungeon::init() {
+	_prefetch.cancel();
+	_next_room = -1;
 	_rooms_visited = 0;
 	_transitioning = false;
-	_used_files.clear();
-	_easy_files.clear();
-	_medium_files.clear();
-	_hard_files.clear();
-	_boss_files.clear();
+	_catalog.clear();
 }
 
 int Dungeon::scan_room_files(int tile_size) {
 	_tile_size = tile_size;
-	_easy_files.clear();
-	_medium_files.clear();
-	_hard_files.clear();
-	_boss_files.clear();
-	_used_files.clear();
+	_catalog.clear();
 
 	std::string base_path = ROOM_PATH;
-	std::string categories[] = {"easy", "medium", "hard", "boss"};
-	std::vector<std::string>* file_lists[] = {&_easy_files, &_medium_files, &_hard_files, &_boss_files};
-
-	for (int i = 0; i < categories->size(); ++i) {
-		std::string dir_path = base_path + "/" + categories[i];
+	for (int i = 0; i < ROOM_CATEGORY_COUNT; ++i) {
+		std::string dir_path = base_path + "/" + room_category_name(i);
 		DIR* dir = opendir(dir_path.c_str());
 		if (!dir) {
 			printf("WARNING: Could not open room directory: %s\n", dir_path.c_str());
 			continue;
 		}
+		std::vector<std::string> files;
 		struct dirent* entry;
 		while ((entry = readdir(dir)) != nullptr) {
 			std::string filename = entry->d_name;
-			if (filename.length() > 5 && filename.substr(filename.length() - 5) == ".room") {
-				file_lists[i]->push_back(dir_path + "/" + filename);
-				printf("DEBUG: Found %s room: %s\n", categories[i].c_str(), filename.c_str());
+			std::string path = dir_path + "/" + filename;
+			// Une salle compilée (.roomb) remplace sa source texte
+			if (has_suffix(filename, ".room")) {
+				if (file_exists(path + "b"))
+					path += "b";
+			} else if (!has_suffix(filename, ROOM_BINARY_EXT)
+				|| file_exists(path.substr(0, path.length() - 1))) {
+				continue;
 			}
+			files.push_back(path);
 		}
 		closedir(dir);
+		// readdir n'a pas d'ordre garanti : trié pour des tirages reproductibles
+		std::sort(files.begin(), files.end());
+		for (const std::string& path : files) {
+			_catalog.add(path, i);
+			printf("DEBUG: Found %s room: %s\n", room_category_name(i), path.c_str());
+		}
 	}
 
-	int total = _easy_files.size() + _medium_files.size() + _hard_files.size() + _boss_files.size();
-	if (total == 0) {
+	if (_catalog.size() == 0) {
 		printf("ERROR: No room files found in %s!\n", base_path.c_str());
 		return -1;
 	}
-	printf("DEBUG: Found %d total room files (easy:%d, medium:%d, hard:%d, boss:%d)\n",
-		total, (int)_easy_files.size(), (int)_medium_files.size(), 
-		(int)_hard_files.size(), (int)_boss_files.size());
+	printf("DEBUG: Found %zu total room files (easy:%d, medium:%d, hard:%d, boss:%d)\n",
+		_catalog.size(), _catalog.count(0), _catalog.count(1), _catalog.count(2), _catalog.count(3));
 	return 0;
 }
 
-std::string Dungeon::pick_next_room_file() {
-	// Filtrer les fichiers déjà utilisés pour chaque catégorie
-	std::vector<std::string> avail[4];
-	const std::vector<std::string>* pools[4] = {&_easy_files, &_medium_files, &_hard_files, &_boss_files};
-
-	for (int cat = 0; cat < 4; ++cat) {
-		for (const auto& f : *pools[cat]) {
-			if (std::find(_used_files.begin(), _used_files.end(), f) == _used_files.end())
-				avail[cat].push_back(f);
-		}
-	}
-
-	// Probabilités pondérées selon la progression du joueur
-	// Plus le joueur avance, plus les salles hard/boss deviennent probables
-	float weights[4];
-	weights[0] = avail[0].empty() ? 0.0f : std::max(1.0f, 50.0f - _rooms_visited * 5.0f);	// easy
-	weights[1] = avail[1].empty() ? 0.0f : std::max(1.0f, 30.0f - _rooms_visited * 2.0f);	// medium
-	weights[2] = avail[2].empty() ? 0.0f : 15.0f + _rooms_visited * 3.0f;					// hard
-	weights[3] = avail[3].empty() ? 0.0f : 5.0f + _rooms_visited * 4.0f;					// boss
-
-	float total = weights[0] + weights[1] + weights[2] + weights[3];
-
-	if (total <= 0.0f) {
-		// Toutes les salles ont été visitées, on reset la liste
-		if (_used_files.empty()) {
-			printf("ERROR: No room files available at all!\n");
-			return "";
-		}
+// Renvoie l'id de la prochaine salle (-1 si le catalogue est vide)
+int Dungeon::pick_next_room() {
+	int resets = _catalog._resets;
+	int category = -1;
+	int id = _catalog.pick(_rooms_visited, *_rng, &category);
+	if (_catalog._resets != resets)
 		printf("DEBUG: All rooms visited, resetting used files list\n");
-		_used_files.clear();
-		return pick_next_room_file();
-	}
-
-	printf("DEBUG: Room weights [easy:%.0f medium:%.0f hard:%.0f boss:%.0f] (visited:%d)\n",
-		weights[0], weights[1], weights[2], weights[3], _rooms_visited);
-
-	// Tirage aléatoire pondéré
-	float roll = (float)random_int(0, 10000) / 10000.0f * total;
-	int chosen_cat = 3;
-	float cumulative = 0.0f;
-	for (int i = 0; i < 4; ++i) {
-		cumulative += weights[i];
-		if (roll < cumulative) {
-			chosen_cat = i;
-			break;
-		}
+	if (id < 0) {
+		printf("ERROR: No room files available at all!\n");
+		return -1;
 	}
-
-	const char* cat_names[] = {"easy", "medium", "hard", "boss"};
-	printf("DEBUG: Picked category: %s\n", cat_names[chosen_cat]);
-
-	// Choisir un fichier au hasard dans la catégorie sélectionnée
-	int idx = random_int(0, (int)avail[chosen_cat].size() - 1);
-	return avail[chosen_cat][idx];
+	printf("DEBUG: Picked category: %s (visited:%d)\n", room_category_name(category), _rooms_visited);
+	return id;
 }
 
+// La salle suivante est tirée dès l'arrivée dans la courante (mêmes poids,
+// même état : le tirage est identique à un tirage fait à la porte) et
+// préchargée ; la transition ne fait alors qu'échanger le template.
 bool Dungeon::load_next_room() {
-	std::string file = pick_next_room_file();
-	if (file.empty())
+	int id = _next_room >= 0 ? _next_room : pick_next_room();
+	_next_room = -1;
+	if (id < 0)
 		return false;
+	const std::string& file = _catalog._files[id];
+
+	std::shared_ptr<const RoomTemplate> tpl = _prefetch.take(file);
+	printf("DEBUG: Room prefetch %s for %s (hits: %d, misses: %d)\n", tpl ? "hit" : "miss",
+		file.c_str(), _prefetch._hits, _prefetch._misses);
+	if (!tpl)
+		return load_room(file);
+	activate_room(std::move(tpl));
+	return true;
+}
 
-	Room new_room;
-	if (!new_room.load_from_file(file, _tile_size))
+bool Dungeon::load_room(const std::string& file) {
+	_room_arena.reset();
+	std::shared_ptr<const RoomTemplate> tpl = _templates.load(file, &_room_arena);
+	if (!tpl)
 		return false;
+	activate_room(std::move(tpl));
+	return true;
+}
 
-	// Centrer la salle sur l'écran
-	float room_width = new_room._width * _tile_size;
-	float room_height = new_room._height * _tile_size;
-	new_room._world_offset = Vector2f(
+void Dungeon::activate_room(std::shared_ptr<const RoomTemplate> tpl) {
+	// Les salles hors catalogue (bench, outils) ne comptent pas comme jouées
+	int id = _catalog.find(tpl->_file);
+	if (id >= 0)
+		_catalog.mark_used(id);
+	_active_room.bind(std::move(tpl), _tile_size);
+
+	// Salle centrée sur l'écran de référence (repère monde inchangé pour les
+	// replays) ; la caméra gère les salles plus grandes que l'écran
+	float room_width = _active_room._width * _tile_size;
+	float room_height = _active_room._height * _tile_size;
+	_active_room._world_offset = Vector2f(
 		(SCREEN_WIDTH - room_width) * 0.5f,
 		(SCREEN_HEIGHT - room_height) * 0.5f
 	);
-	new_room._room_id = _rooms_visited;
-
-	_used_files.push_back(file);
-	_active_room = new_room;
+	_active_room._room_id = _rooms_visited;
+	_tile_layer.invalidate();
+	// Première salle : la caméra se place directement sur le joueur
+	_transitioning = _rooms_visited > 0;
 	_rooms_visited++;
 
-	printf("DEBUG: Loaded room %s (total visited: %d)\n", file.c_str(), _rooms_visited);
-	return true;
+	printf("DEBUG: Loaded room %s (total visited: %d, templates: %zu)\n",
+		_active_room._template->_file.c_str(), _rooms_visited, _templates.size());
+
+	_next_room = pick_next_room();
+	if (_next_room >= 0)
+		_prefetch.request(_catalog._files[_next_room]);
 }
 
-void Dungeon::update(float dt) {
+// focus : position du joueur à ce tick
+void Dungeon::update(float dt, const Vector2f& focus) {
+	_camera_target = camera_center(focus);
 	if (_transitioning) {
 		Vector2f diff = _camera_target - _camera_pos;
 		if (diff.length() < 10.0f) {
 			_camera_pos = _camera_target;
 			_transitioning = false;
 		} else {
+			// Vitesse minimale, accélérée sur les longues distances (grandes salles)
+			float speed = std::max(_camera_transition_speed, diff.length() * CAMERA_CATCHUP_RATE);
 			Vector2f dir = diff.normalized();
-			_camera_pos = _camera_pos + (dir * _camera_transition_speed * dt);
+			_camera_pos = _camera_pos + (dir * std::min(speed * dt, diff.length()));
 		}
+	} else {
+		_camera_pos = _camera_target;
 	}
 }
 
+// Centre de vue qui suit focus sans montrer l'extérieur de la salle ; sur un
+// axe où la salle tient dans l'écran, elle reste centrée
+Vector2f Dungeon::camera_center(const Vector2f& focus) const {
+	const Room& room = _active_room;
+	float half_w = SCREEN_WIDTH * 0.5f;
+	float half_h = SCREEN_HEIGHT * 0.5f;
+	float left = room._world_offset._x;
+	float top = room._world_offset._y;
+	float right = left + room._width * room._tile_size;
+	float bottom = top + room._height * room._tile_size;
+	Vector2f center;
+	center._x = right - left <= SCREEN_WIDTH ? (left + right) * 0.5f
+		: std::min(std::max(focus._x, left + half_w), right - half_w);
+	center._y = bottom - top <= SCREEN_HEIGHT ? (top + bottom) * 0.5f
+		: std::min(std::max(focus._y, top + half_h), bottom - half_h);
+	return center;
+}
+
+// focus : position interpolée du joueur. Pendant une transition, la vue suit
+// _camera_pos. Le centre est arrondi au pixel (pas de coutures entre tuiles).
+Camera2D Dungeon::camera(const Vector2f& focus) const {
+	Vector2f center = _transitioning ? _camera_pos : camera_center(focus);
+	Camera2D camera;
+	camera.offset = {SCREEN_WIDTH * 0.5f, SCREEN_HEIGHT * 0.5f};
+	camera.target = {std::round(center._x), std::round(center._y)};
+	camera.rotation = 0;
+	camera.zoom = 1.0f;
+	return camera;
+}
+
 Room& Dungeon::current_room() {
 	return _active_room;
 }
@@ -303,6 +925,126 @@ const Room& Dungeon::current_room() const {
 	return _active_room;
 }
 
-void Dungeon::draw() const {
-	_active_room.draw();
+void Dungeon::draw(const Rectangle& view) const {
+	_tile_layer.draw(_active_room, view);
+}
+
+// À appeler avant CloseWindow : la texture vit dans le contexte GPU
+void Dungeon::unload_render_cache() {
+	_tile_layer.unload();
+	_tile_layer.invalidate();
+}
+
+// ============================================================================
+// ROOM TEMPLATE CACHE
+// ============================================================================
+
+RoomTemplateCache::RoomTemplateCache() : _loads(0) {}
+
+std::shared_ptr<const RoomTemplate> RoomTemplateCache::find(const std::string& file) {
+	std::lock_guard<std::mutex> lock(_lock);
+	auto it = _templates.find(file);
+	return it == _templates.end() ? nullptr : it->second;
+}
+
+// Renvoie le template déjà parsé, sinon le parse (hors verrou) et le garde
+// scratch sert aux tableaux temporaires du parse et de l'analyse
+std::shared_ptr<const RoomTemplate> RoomTemplateCache::load(const std::string& file, std::pmr::memory_resource* scratch) {
+	std::shared_ptr<const RoomTemplate> cached = find(file);
+	if (cached)
+		return cached;
+
+	std::shared_ptr<RoomTemplate> tpl = std::make_shared<RoomTemplate>();
+	if (!tpl->load(file, scratch))
+		return nullptr;
+
+	std::lock_guard<std::mutex> lock(_lock);
+	// Un autre thread a pu le parser entre-temps : on garde le premier
+	auto inserted = _templates.emplace(file, tpl);
+	if (inserted.second)
+		_loads++;
+	return inserted.first->second;
+}
+
+size_t RoomTemplateCache::size() {
+	std::lock_guard<std::mutex> lock(_lock);
+	return _templates.size();
+}
+
+// ============================================================================
+// ROOM PREFETCHER
+// ============================================================================
+
+RoomPrefetcher::RoomPrefetcher(RoomTemplateCache* cache)
+	: _cache(cache), _stop(false), _hits(0), _misses(0), _arena(ROOM_ARENA_SIZE) {}
+
+RoomPrefetcher::~RoomPrefetcher() {
+	stop();
+}
+
+// Remplace toute demande précédente ; le thread démarre à la première demande
+void RoomPrefetcher::request(const std::string& file) {
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		_request = file;
+		_stop = false;
+	}
+	if (!_thread.joinable())
+		_thread = std::thread(&RoomPrefetcher::worker_loop, this);
+	_wake.notify_one();
+}
+
+// Récupère le template de la salle s'il est déjà en cache. S'il est encore
+// en cours de chargement on l'attend (compté comme miss : la frame a bloqué).
+std::shared_ptr<const RoomTemplate> RoomPrefetcher::take(const std::string& file) {
+	bool in_flight;
+	{
+		std::unique_lock<std::mutex> lock(_lock);
+		in_flight = (_request == file || _loading == file);
+		_done.wait(lock, [&] { return _request != file && _loading != file; });
+	}
+	std::shared_ptr<const RoomTemplate> tpl = _cache->find(file);
+	if (tpl && !in_flight)
+		_hits++;
+	else
+		_misses++;
+	return tpl;
+}
+
+void RoomPrefetcher::cancel() {
+	std::lock_guard<std::mutex> lock(_lock);
+	_request.clear();
+}
+
+void RoomPrefetcher::stop() {
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		_stop = true;
+		_request.clear();
+	}
+	_wake.notify_all();
+	if (_thread.joinable())
+		_thread.join();
+}
+
+void RoomPrefetcher::worker_loop() {
+	std::unique_lock<std::mutex> lock(_lock);
+	while (true) {
+		_wake.wait(lock, [&] { return _stop || !_request.empty(); });
+		if (_stop)
+			return;
+		std::string file = _request;
+		_loading = file;
+		_request.clear();
+
+		// Le parse se fait hors verrou ; un échec laisse le cache vide pour ce
+		// fichier et la transition rechargera en synchrone
+		lock.unlock();
+		_arena.reset();
+		_cache->load(file, &_arena);
+		lock.lock();
+
+		_loading.clear();
+		_done.notify_all();
+	}
 }
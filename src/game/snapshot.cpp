@@ -0,0 +1,252 @@
+#include "game.h"
+
+// ============================================================================
+// SNAPSHOT : sections par conteneur
+// ============================================================================
+//
+// Chaque save() a son restore() qui relit exactement les mêmes sections dans
+// le même ordre. Les caches dérivés (grille spatiale, flow field, couche de
+// tuiles, tampons de spawn) ne sont pas sauvés : ils se reconstruisent seuls.
+
+void	HandleTable::save(Snapshot& out) const {
+	out.write_array(_slot_of);
+	out.write_array(_index_of);
+	out.write_array(_generation);
+	out.write_array(_free_slots);
+}
+
+void	HandleTable::restore(Snapshot& in) {
+	in.read_array(_slot_of);
+	in.read_array(_index_of);
+	in.read_array(_generation);
+	in.read_array(_free_slots);
+}
+
+void	EntityStore::save(Snapshot& out) const {
+	out.write_array(_pos_x);
+	out.write_array(_pos_y);
+	out.write_array(_prev_x);
+	out.write_array(_prev_y);
+	out.write_array(_vel_x);
+	out.write_array(_vel_y);
+	out.write_array(_radius);
+	out.write_array(_hp);
+	out.write_array(_alive);
+	out.write_array(_archetype);
+	out.write_array(_max_hp);
+	out.write_array(_speed);
+	out.write_array(_dammage);
+	out.write_array(_shoot_timer);
+	out.write_array(_shoot_cooldown);
+	out.write(_type_start);
+	_handles.save(out);
+}
+
+void	EntityStore::restore(Snapshot& in) {
+	in.read_array(_pos_x);
+	in.read_array(_pos_y);
+	in.read_array(_prev_x);
+	in.read_array(_prev_y);
+	in.read_array(_vel_x);
+	in.read_array(_vel_y);
+	in.read_array(_radius);
+	in.read_array(_hp);
+	in.read_array(_alive);
+	in.read_array(_archetype);
+	in.read_array(_max_hp);
+	in.read_array(_speed);
+	in.read_array(_dammage);
+	in.read_array(_shoot_timer);
+	in.read_array(_shoot_cooldown);
+	in.read(_type_start);
+	_handles.restore(in);
+}
+
+void	ProjectilePool::save(Snapshot& out) const {
+	out.write_array(_items);
+	_handles.save(out);
+	out.write(_high_water);
+	out.write(_exhausted);
+}
+
+// La capacité du pool n'est pas sauvée : l'instantané vient du même pool
+void	ProjectilePool::restore(Snapshot& in) {
+	in.read_array(_items);
+	_handles.restore(in);
+	in.read(_high_water);
+	in.read(_exhausted);
+}
+
+// Les points de spawn pointent dans l'analyse de la salle : sauvés en
+// décalage depuis le début de RoomAnalysis::_spawns (-1 = aucun)
+void	WaveSpawner::save(Snapshot& out, const Room& room) const {
+	const int* base = room.analysis()._spawns.data();
+	int64_t offsets[ENTITY_ARCHETYPE_COUNT];
+	for (int a = 0; a < ENTITY_ARCHETYPE_COUNT; ++a)
+		offsets[a] = _candidates[a] ? _candidates[a] - base : -1;
+	out.write(_enabled);
+	out.write(_wave);
+	out.write(_timer);
+	out.write(_hp_scale);
+	out.write_array(_queue);
+	out.write(_next);
+	out.write(offsets);
+	out.write(_candidate_count);
+	out.write(_spawned);
+}
+
+void	WaveSpawner::restore(Snapshot& in, const Room& room) {
+	int64_t offsets[ENTITY_ARCHETYPE_COUNT];
+	in.read(_enabled);
+	in.read(_wave);
+	in.read(_timer);
+	in.read(_hp_scale);
+	in.read_array(_queue);
+	in.read(_next);
+	in.read(offsets);
+	in.read(_candidate_count);
+	in.read(_spawned);
+	const int* base = room.analysis()._spawns.data();
+	for (int a = 0; a < ENTITY_ARCHETYPE_COUNT; ++a)
+		_candidates[a] = offsets[a] < 0 ? nullptr : base + offsets[a];
+}
+
+// Catalogue relu d'un instantané : même nombre de salles par catégorie que
+// le catalogue scanné, et _order / _position inverses l'un de l'autre.
+// Sinon l'instantané vient d'un autre catalogue et ses indices débordent.
+bool	Dungeon::catalog_matches(const size_t order_size[ROOM_CATEGORY_COUNT]) const {
+	if (_catalog._position.size() != _catalog.size())
+		return false;
+	for (int c = 0; c < ROOM_CATEGORY_COUNT; ++c) {
+		const std::vector<int>& order = _catalog._order[c];
+		if (order.size() != order_size[c] || _catalog._available[c] < 0
+			|| _catalog._available[c] > (int)order.size())
+			return false;
+		for (size_t k = 0; k < order.size(); ++k) {
+			int id = order[k];
+			if (id < 0 || id >= (int)_catalog.size() || _catalog._category[id] != c
+				|| _catalog._position[id] != (int)k)
+				return false;
+		}
+	}
+	return true;
+}
+
+// La salle est identifiée par son fichier ; le template vient du cache (et
+// n'est rechargé que si l'instantané a été pris dans une autre salle)
+void	Dungeon::save(Snapshot& out) const {
+	out.write_string(_active_room._template ? _active_room._template->_file : std::string());
+	out.write(_active_room._room_id);
+	out.write(_active_room._world_offset);
+	out.write(_rooms_visited);
+	out.write(_next_room);
+	out.write(_camera_target);
+	out.write(_camera_pos);
+	out.write(_transitioning);
+	out.write_array(_catalog._position);
+	for (int c = 0; c < ROOM_CATEGORY_COUNT; ++c)
+		out.write_array(_catalog._order[c]);
+	out.write(_catalog._available);
+	out.write(_catalog._resets);
+}
+
+bool	Dungeon::restore(Snapshot& in) {
+	std::string file;
+	if (!in.read_string(file))
+		return false;
+	if (!_active_room._template || _active_room._template->_file != file) {
+		std::shared_ptr<const RoomTemplate> tpl = _templates.load(file);
+		if (!tpl) {
+			printf("ERROR: Snapshot room %s cannot be loaded\n", file.c_str());
+			return false;
+		}
+		_active_room.bind(std::move(tpl), _tile_size);
+		_tile_layer.invalidate();
+	}
+	in.read(_active_room._room_id);
+	in.read(_active_room._world_offset);
+	in.read(_rooms_visited);
+	int next_room = _next_room;
+	in.read(_next_room);
+	in.read(_camera_target);
+	in.read(_camera_pos);
+	in.read(_transitioning);
+	size_t order_size[ROOM_CATEGORY_COUNT];
+	for (int c = 0; c < ROOM_CATEGORY_COUNT; ++c)
+		order_size[c] = _catalog._order[c].size();
+	in.read_array(_catalog._position);
+	for (int c = 0; c < ROOM_CATEGORY_COUNT; ++c)
+		in.read_array(_catalog._order[c]);
+	in.read(_catalog._available);
+	in.read(_catalog._resets);
+	if (!in._ok)
+		return false;
+	if (!catalog_matches(order_size)) {
+		printf("ERROR: Snapshot room catalog does not match (%zu rooms)\n", _catalog.size());
+		return false;
+	}
+	if (_next_room != next_room && _next_room >= 0 && _next_room < (int)_catalog.size())
+		_prefetch.request(_catalog._files[_next_room]);
+	return true;
+}
+
+// ============================================================================
+// GAME
+// ============================================================================
+
+// Écrase out : le tampon est réutilisé, sans allocation une fois assez grand
+void	Game::save_snapshot(Snapshot& out) const {
+	out.clear();
+	out.write(SNAPSHOT_MAGIC);
+	out.write(SNAPSHOT_VERSION);
+	out.write(_state);
+	out.write(_next_state);
+	out.write(_input);
+	out.write(_pending_input);
+	out.write(_accumulator);
+	out.write(_alpha);
+	out.write(_time_elapsed);
+	out.write(_score);
+	out.write(_rng);
+	out.write(_player);
+	_dungeon.save(out);
+	_enemies.save(out);
+	_projectiles.save(out);
+	_spawner.save(out, _dungeon.current_room());
+}
+
+// Un instantané pris sur une autre version du jeu ou un autre catalogue de
+// salles n'est pas reconnu. En cas d'échec au milieu de la lecture (tampon
+// tronqué), l'état est incohérent : relancer init() ou un autre instantané.
+bool	Game::restore_snapshot(Snapshot& in) {
+	in.rewind();
+	char magic[4];
+	uint16_t version = 0;
+	if (!in.read(magic) || !in.read(version)
+		|| std::memcmp(magic, SNAPSHOT_MAGIC, 4) != 0 || version != SNAPSHOT_VERSION) {
+		printf("ERROR: Bad snapshot (magic or version)\n");
+		return false;
+	}
+	in.read(_state);
+	in.read(_next_state);
+	in.read(_input);
+	in.read(_pending_input);
+	in.read(_accumulator);
+	in.read(_alpha);
+	in.read(_time_elapsed);
+	in.read(_score);
+	in.read(_rng);
+	in.read(_player);
+	if (!_dungeon.restore(in)) {
+		printf("ERROR: Bad snapshot (dungeon)\n");
+		return false;
+	}
+	_enemies.restore(in);
+	_projectiles.restore(in);
+	_spawner.restore(in, _dungeon.current_room());
+	if (!in._ok || in._read != in._size) {
+		printf("ERROR: Bad snapshot (truncated or trailing data)\n");
+		return false;
+	}
+	return true;
+}
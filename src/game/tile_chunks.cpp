@@ -0,0 +1,118 @@
+#include "game.h"
+
+// ============================================================================
+// TILE CHUNKS
+// ============================================================================
+
+TileChunks::TileChunks()
+	:	_width(0), _height(0), _chunks_x(0), _chunks_y(0),
+		_block(nullptr), _value(nullptr), _blocks(nullptr), _block_count(0) {}
+
+// Recopie ligne par ligne dans out (width * height octets, ligne par ligne)
+void	TileChunks::decode(uint8_t* out) const {
+	for (int cy = 0; cy < _chunks_y; ++cy) {
+		int rows = std::min(TILE_CHUNK_SIZE, _height - cy * TILE_CHUNK_SIZE);
+		for (int cx = 0; cx < _chunks_x; ++cx) {
+			size_t chunk = (size_t)cy * _chunks_x + cx;
+			int x0 = cx * TILE_CHUNK_SIZE;
+			int cols = std::min(TILE_CHUNK_SIZE, _width - x0);
+			for (int row = 0; row < rows; ++row) {
+				uint8_t* dst = out + (size_t)(cy * TILE_CHUNK_SIZE + row) * _width + x0;
+				if (_block[chunk] == TILE_CHUNK_UNIFORM)
+					std::memset(dst, _value[chunk], cols);
+				else
+					std::memcpy(dst, _blocks + (size_t)_block[chunk] * TILE_CHUNK_AREA + row * TILE_CHUNK_SIZE, cols);
+			}
+		}
+	}
+}
+
+// ============================================================================
+// TILE CHUNK STORE
+// ============================================================================
+
+TileChunkStore::TileChunkStore() : _width(0), _height(0), _chunks_x(0), _chunks_y(0) {}
+
+// Copie le chunk (cx, cy) d'une grille ligne par ligne dans block, complété
+// par des murs au-delà des bords
+static void	extract_chunk(const uint8_t* tiles, int width, int height, int cx, int cy, uint8_t* block) {
+	int x0 = cx * TILE_CHUNK_SIZE;
+	int y0 = cy * TILE_CHUNK_SIZE;
+	int cols = std::min(TILE_CHUNK_SIZE, width - x0);
+	int rows = std::min(TILE_CHUNK_SIZE, height - y0);
+	std::memset(block, Room::WALL, TILE_CHUNK_AREA);
+	for (int row = 0; row < rows; ++row)
+		std::memcpy(block + row * TILE_CHUNK_SIZE, tiles + (size_t)(y0 + row) * width + x0, cols);
+}
+
+// Découpe une grille ligne par ligne (width * height octets) ; seuls les
+// chunks contenant plusieurs valeurs reçoivent un bloc. Deux passes : les
+// blocs sont comptés avant d'être alloués en une fois.
+void	TileChunkStore::assign(int width, int height, const uint8_t* tiles) {
+	_width = width;
+	_height = height;
+	_chunks_x = (width + TILE_CHUNK_MASK) >> TILE_CHUNK_SHIFT;
+	_chunks_y = (height + TILE_CHUNK_MASK) >> TILE_CHUNK_SHIFT;
+	size_t chunks = (size_t)_chunks_x * _chunks_y;
+	_block.assign(chunks, TILE_CHUNK_UNIFORM);
+	_value.assign(chunks, Room::WALL);
+
+	uint8_t block[TILE_CHUNK_AREA];
+	uint32_t detailed = 0;
+	for (int cy = 0; cy < _chunks_y; ++cy) {
+		for (int cx = 0; cx < _chunks_x; ++cx) {
+			size_t chunk = (size_t)cy * _chunks_x + cx;
+			extract_chunk(tiles, width, height, cx, cy, block);
+			if (std::all_of(block + 1, block + TILE_CHUNK_AREA, [&](uint8_t t) { return t == block[0]; }))
+				_value[chunk] = block[0];
+			else
+				_block[chunk] = detailed++;
+		}
+	}
+
+	_blocks.resize((size_t)detailed * TILE_CHUNK_AREA);
+	for (int cy = 0; cy < _chunks_y; ++cy) {
+		for (int cx = 0; cx < _chunks_x; ++cx) {
+			uint32_t b = _block[(size_t)cy * _chunks_x + cx];
+			if (b != TILE_CHUNK_UNIFORM)
+				extract_chunk(tiles, width, height, cx, cy, &_blocks[(size_t)b * TILE_CHUNK_AREA]);
+		}
+	}
+}
+
+void	TileChunkStore::copy(const TileChunks& tiles) {
+	_width = tiles._width;
+	_height = tiles._height;
+	_chunks_x = tiles._chunks_x;
+	_chunks_y = tiles._chunks_y;
+	_block.assign(tiles._block, tiles._block + tiles.chunk_count());
+	_value.assign(tiles._value, tiles._value + tiles.chunk_count());
+	_blocks.assign(tiles._blocks, tiles._blocks + tiles._block_count * TILE_CHUNK_AREA);
+}
+
+// Un chunk uniforme reçoit un bloc à sa première tuile différente
+// (les blocs redevenus uniformes ne sont pas refusionnés)
+void	TileChunkStore::set(int x, int y, uint8_t value) {
+	size_t chunk = (size_t)(y >> TILE_CHUNK_SHIFT) * _chunks_x + (x >> TILE_CHUNK_SHIFT);
+	if (_block[chunk] == TILE_CHUNK_UNIFORM) {
+		if (_value[chunk] == value)
+			return;
+		_block[chunk] = (uint32_t)(_blocks.size() / TILE_CHUNK_AREA);
+		_blocks.insert(_blocks.end(), TILE_CHUNK_AREA, _value[chunk]);
+	}
+	_blocks[(size_t)_block[chunk] * TILE_CHUNK_AREA + ((y & TILE_CHUNK_MASK) << TILE_CHUNK_SHIFT) + (x & TILE_CHUNK_MASK)] = value;
+}
+
+// Vue invalidée par le prochain assign(), copy() ou set()
+TileChunks	TileChunkStore::view() const {
+	TileChunks tiles;
+	tiles._width = _width;
+	tiles._height = _height;
+	tiles._chunks_x = _chunks_x;
+	tiles._chunks_y = _chunks_y;
+	tiles._block = _block.data();
+	tiles._value = _value.data();
+	tiles._blocks = _blocks.data();
+	tiles._block_count = _blocks.size() / TILE_CHUNK_AREA;
+	return tiles;
+}
@@ -0,0 +1,107 @@
+#include "game.h"
+
+// ============================================================================
+// VAGUES SCRIPTÉES
+// ============================================================================
+
+constexpr WaveDef	DEFAULT_WAVES[] = {
+	// squelettes, vampires, prêtres, inconnus | durée (s) | PV
+	{{6, 0, 0, 0}, 4.0f, 1.0f},
+	{{8, 4, 0, 0}, 5.0f, 1.0f},
+	{{10, 6, 2, 0}, 6.0f, 1.1f},
+	{{16, 10, 4, 0}, 8.0f, 1.2f},
+	{{40, 24, 8, 0}, 10.0f, 1.35f},
+	{{150, 90, 30, 0}, 15.0f, 1.5f},
+};
+
+const float	WAVE_REPEAT_HP_STEP = 0.25f;	// PV en plus à chaque répétition de la dernière vague
+
+// ============================================================================
+// WAVE SPAWNER
+// ============================================================================
+
+WaveSpawner::WaveSpawner()
+	:	_waves(DEFAULT_WAVES),
+		_wave_count((int)(sizeof(DEFAULT_WAVES) / sizeof(DEFAULT_WAVES[0]))),
+		_enabled(true) {
+	reset();
+}
+
+void	WaveSpawner::reset() {
+	_wave = -1;
+	_timer = 0;
+	_hp_scale = 1.0f;
+	_queue.clear();
+	_next = 0;
+	std::fill(_candidates, _candidates + ENTITY_ARCHETYPE_COUNT, nullptr);
+	std::fill(_candidate_count, _candidate_count + ENTITY_ARCHETYPE_COUNT, 0);
+	_spawned = 0;
+}
+
+const WaveDef&	WaveSpawner::wave_def(int wave) const {
+	return _waves[std::min(std::max(wave, 0), _wave_count - 1)];
+}
+
+// Les points de spawn viennent de la composante du joueur : tout ennemi peut
+// l'atteindre. Un archétype trop large pour la salle est retiré de la vague.
+void	WaveSpawner::start_wave(int wave, const Room& room, const Vector2f& player_pos, EntityStore& enemies, Rng& rng) {
+	const WaveDef& def = wave_def(wave);
+	int repeats = std::max(wave - (_wave_count - 1), 0);
+	_wave = wave;
+	_timer = 0;
+	_next = 0;
+	_hp_scale = def._hp_scale * (1.0f + WAVE_REPEAT_HP_STEP * repeats);
+
+	int component = room.component_at(player_pos);
+	if (component < 0)
+		component = room.component_at(room.get_spawn());
+	_queue.clear();
+	for (int a = 0; a < ENTITY_ARCHETYPE_COUNT; ++a) {
+		_candidate_count[a] = room.spawn_candidates(archetypes().entity(a)._radius, component, _candidates[a]);
+		if (_candidate_count[a] > 0)
+			_queue.insert(_queue.end(), def._counts[a], (uint8_t)a);
+	}
+	// Fisher-Yates : les types arrivent entremêlés
+	for (size_t i = _queue.size(); i > 1; --i)
+		std::swap(_queue[i - 1], _queue[rng.range(0, (int)i - 1)]);
+	enemies.reserve(enemies.size() + _queue.size());
+	printf("DEBUG: Wave %d: %zu spawns over %.1fs (hp x%.2f)\n", _wave + 1, _queue.size(), def._duration, _hp_scale);
+}
+
+void	WaveSpawner::update(float dt, const Room& room, const Vector2f& player_pos, EntityStore& enemies, Rng& rng) {
+	if (!_enabled)
+		return;
+	_timer += dt;
+	if (wave_done()) {
+		if (_timer < (enemies.empty() ? WAVE_PAUSE : WAVE_INTERVAL))
+			return;
+		start_wave(_wave + 1, room, player_pos, enemies, rng);
+	}
+
+	// Apparitions dues à ce stade de la vague (réparties uniformément)
+	const WaveDef& def = wave_def(_wave);
+	size_t due = _queue.size();
+	if (_timer < def._duration)
+		due = std::min(due, (size_t)(_queue.size() * (_timer / def._duration)) + 1);
+	for (; _next < due; ++_next) {
+		int a = _queue[_next];
+		Entity e((Entity::Type)a, room.tile_center(_candidates[a][rng.range(0, _candidate_count[a] - 1)]));
+		e._hp *= _hp_scale;
+		e._max_hp = e._hp;
+		enemies.spawn(e);
+		++_spawned;
+	}
+	// Dernière apparition : _timer compte maintenant l'attente de la vague suivante
+	if (wave_done())
+		_timer = 0;
+}
+
+// Changement de salle : les ennemis ont été retirés et les points de spawn ne
+// valent plus. Une vague interrompue sera rejouée après la pause.
+void	WaveSpawner::enter_room() {
+	if (!wave_done())
+		--_wave;
+	_queue.clear();
+	_next = 0;
+	_timer = 0;
+}
@@ -2,61 +2,104 @@
 
 Weapon::Weapon(Type t)
 	: _type(t) {
-	switch (t) {
-		case SWORD:
-			_damage = 25.0f;
-			_range = 50.0f;
-			_cooldown = 0.5f;
-			break;
-		case BOW:
-			_damage = 15.0f;
-			_range = 200.0f;
-			_cooldown = 1.0f;
-			break;
-		case STAFF:
-			_damage = 20.0f;
-			_range = 100.0f;
-			_cooldown = 0.8f;
-			break;
-		default:
-			_damage = 10.0f;
-			_range = 50.0f;
-			_cooldown = 1.0f;
-			break;
-	}
+	const WeaponArchetype& a = archetypes().weapon(t);
+	_damage = a._damage;
+	_range = a._range;
+	_cooldown = a._cooldown;
 }
 
 // ============================================================================
 // PROJECTILE
 // ============================================================================
 
+// Projectile mort, écrasé ensuite (restauration d'un instantané)
+Projectile::Projectile()
+	: _damage(0), _radius(0), _lifetime(0), _alive(false), _from_player(false) {}
+
 Projectile::Projectile(const Vector2f& pos, const Vector2f& vel, float damage, float radius, bool from_player, float lifetime)
-	: _pos(pos), _vel(vel), _damage(damage), _radius(radius), _lifetime(lifetime), _alive(true), _from_player(from_player) {}
+	: _pos(pos), _prev_pos(pos), _vel(vel), _damage(damage), _radius(radius), _lifetime(lifetime), _alive(true), _from_player(from_player) {}
 
 void	Projectile::update(float dt, const Room& room) {
 	if (!_alive)
 		return;
 	
-	_pos = _pos + _vel * dt;
+	Vector2f target = _pos + _vel * dt;
 	_lifetime -= dt;
 	
 	if (_lifetime <= 0)
 		_alive = false;
 	
-	// Collision avec les murs
-	if (!room.is_walkable(_pos, _radius))
+	// Collision continue avec les murs : arrêt au premier contact sur le trajet
+	float t;
+	if (room.sweep_circle(_pos, target, _radius, t)) {
+		_pos = lerp(_pos, target, t);
 		_alive = false;
+	} else {
+		_pos = target;
+	}
 }
 
-void	Projectile::draw() const {
+void	Projectile::draw(float alpha) const {
 	if (!_alive)
 		return;
 	
+	Vector2f pos = lerp(_prev_pos, _pos, alpha);
 	Color color = _from_player ? SKYBLUE : ORANGE;
-	DrawCircleV({_pos._x, _pos._y}, _radius, color);
+	DrawCircleV({pos._x, pos._y}, _radius, color);
 	
 	// Traînée visuelle
-	Vector2f trail = _pos - _vel.normalized() * (_radius * 2.0f);
-	DrawLineEx({trail._x, trail._y}, {_pos._x, _pos._y}, _radius * 0.6f, 
+	Vector2f trail = pos - _vel.normalized() * (_radius * 2.0f);
+	DrawLineEx({trail._x, trail._y}, {pos._x, pos._y}, _radius * 0.6f, 
 		_from_player ? Color{135, 206, 235, 100} : Color{255, 165, 0, 100});
+	render_stats()._draw_calls += 2;
+}
+
+// ============================================================================
+// PROJECTILE POOL
+// ============================================================================
+
+ProjectilePool::ProjectilePool(size_t capacity)
+	: _capacity(capacity), _high_water(0), _exhausted(0) {
+	_items.reserve(capacity);
+	_handles.reserve(capacity);
+}
+
+// Renvoie une poignée invalide (et compte l'échec) si le pool est plein
+Handle	ProjectilePool::spawn(const Projectile& p) {
+	if (_items.size() >= _capacity) {
+		_exhausted++;
+		return Handle();
+	}
+	Handle h = _handles.acquire((uint32_t)_items.size());
+	_items.push_back(p);
+	_high_water = std::max(_high_water, _items.size());
+	return h;
+}
+
+Projectile*	ProjectilePool::get(Handle h) {
+	int i = _handles.index(h);
+	return i < 0 ? nullptr : &_items[i];
+}
+
+void	ProjectilePool::clear() {
+	_items.clear();
+	_handles.clear();
+}
+
+size_t	ProjectilePool::remove_dead() {
+	size_t removed = 0;
+	for (size_t i = _items.size(); i-- > 0;) {
+		if (!_items[i]._alive) {
+			swap_remove(i);
+			++removed;
+		}
+	}
+	return removed;
+}
+
+void	ProjectilePool::swap_remove(size_t i) {
+	_handles.release(i);
+	if (i != _items.size() - 1)
+		_items[i] = _items.back();
+	_items.pop_back();
 }
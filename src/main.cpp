@@ -1,29 +1,119 @@
 #include "game.h"
+#include <cstdlib>
+#include <cstring>
 
-int main() {	
+int main(int argc, char** argv) {	
 	Game game;
+	// --tick-rate N : fréquence de la simulation (indépendante du rendu)
+	// --threads N : threads de travail pour l'update des ennemis
+	// --trace FILE : trace Chrome des zones du profiler à la fermeture (make PROFILE=1)
+	// --seed S : graine de la partie (aléatoire sinon)
+	// --record FILE : enregistre graine + input de chaque tick
+	// --replay FILE [--fast] : rejoue un enregistrement, à vitesse normale ou
+	//   en accéléré sans fenêtre (code de retour 1 si l'état diverge)
+	int threads = JobSystem::default_thread_count();
+	const char* trace_file = nullptr;
+	const char* record_file = nullptr;
+	const char* replay_file = nullptr;
+	bool fast = false;
+	for (int i = 1; i < argc; ++i) {
+		bool has_value = (i + 1 < argc);
+		if (std::strcmp(argv[i], "--tick-rate") == 0 && has_value)
+			game._tick_rate = std::max(1, std::atoi(argv[++i]));
+		else if (std::strcmp(argv[i], "--threads") == 0 && has_value)
+			threads = std::max(0, std::atoi(argv[++i]));
+		else if (std::strcmp(argv[i], "--trace") == 0 && has_value)
+			trace_file = argv[++i];
+		else if (std::strcmp(argv[i], "--seed") == 0 && has_value)
+			game._rng.seed((uint32_t)std::strtoul(argv[++i], nullptr, 10));
+		else if (std::strcmp(argv[i], "--record") == 0 && has_value)
+			record_file = argv[++i];
+		else if (std::strcmp(argv[i], "--replay") == 0 && has_value)
+			replay_file = argv[++i];
+		else if (std::strcmp(argv[i], "--fast") == 0)
+			fast = true;
+	}
+	game.set_thread_count(threads);
+
+	// Le replay impose sa graine et sa fréquence avant init() (tirage des salles)
+	ReplayInput replay;
+	if (replay_file) {
+		if (!replay.load(replay_file))
+			return 1;
+		game._rng.seed(replay._header._seed);
+		game._tick_rate = replay._header._tick_rate;
+		game._replay = &replay;
+	}
+	InputRecorder recorder;
+	if (record_file && !replay_file) {
+		if (!recorder.open(record_file, game))
+			return 1;
+		game._recorder = &recorder;
+	}
+
 	if (game.init() != 0)
 	{
 		if (IsWindowReady())
 			CloseWindow();
 		return 0;
 	}
+
+	if (replay_file && fast) {
+		// Accéléré : ticks enchaînés sans fenêtre ni rendu
+		InputState tick_input;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		while (!replay.done()) {
+			replay.poll(game, tick_input);
+			game.tick(tick_input);
+		}
+		replay.verify(game);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		printf("DEBUG: Replayed %u ticks in %.2fs (%.0fx real time), %d checksums, %d divergent (first at tick %lld)\n",
+			replay._ticks, seconds, seconds > 0 ? replay._ticks / (seconds * game._tick_rate) : 0.0,
+			replay._checked, replay._divergences, (long long)replay._first_divergence);
+		if (trace_file)
+			profiler().dump_chrome_trace(trace_file);
+		return replay._divergences ? 1 : 0;
+	}
 	
 	// Init Raylib
 	InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Curse of the Fractured Veil");
 	SetTargetFPS(TARGET_FPS);
+	// Atlas des sprites (make atlas) : sans lui, les ennemis restent des cercles
+	if (std::ifstream(ATLAS_FILE).good())
+		sprite_atlas().load(ATLAS_FILE);
+	else
+		printf("DEBUG: No sprite atlas (%s), run make atlas\n", ATLAS_FILE.c_str());
+	RaylibInput input_source;
+	InputState input;
+	bool show_profiler = false;
 	// Boucle principale
 	while (!WindowShouldClose()) {
 		float dt = GetFrameTime();
 		
-		game.handle_input();
-		game.update(dt);
+		input_source.poll(game, input);
+		game.step_frame(dt, input);
+		// F3 : percentiles des zones du profiler (vide sans make PROFILE=1)
+		if (IsKeyPressed(KEY_F3))
+			show_profiler = !show_profiler;
 		
 		BeginDrawing();
 		ClearBackground({00, 00, 30, 255});
 		game.draw();
+		if (show_profiler)
+			profiler().draw_overlay(SCREEN_WIDTH - 440, 90);
 		EndDrawing();
 	}
+	if (replay_file) {
+		replay.verify(game);
+		printf("DEBUG: Replay stopped at tick %u, %d checksums, %d divergent\n",
+			replay._ticks, replay._checked, replay._divergences);
+	}
+	recorder.close();
+	if (trace_file)
+		profiler().dump_chrome_trace(trace_file);
+	game._dungeon.unload_render_cache();
+	sprite_atlas().unload();
 	CloseWindow();
 	return 0;
 }
@@ -0,0 +1,31 @@
+#include "game.h"
+
+// ============================================================================
+// ARENA
+// ============================================================================
+
+// Le débordement repart du tas par blocs croissants, rendus au reset()
+Arena::Arena(size_t capacity)
+	:	_block(new uint8_t[capacity]),
+		_capacity(capacity),
+		_offset(0),
+		_high_water(0),
+		_overflows(0),
+		_overflow(std::pmr::new_delete_resource()) {}
+
+void	Arena::reset() {
+	_offset = 0;
+	_overflow.release();
+}
+
+void*	Arena::do_allocate(size_t bytes, size_t alignment) {
+	uintptr_t base = (uintptr_t)_block.get();
+	size_t start = ((base + _offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+	if (start + bytes <= _capacity) {
+		_offset = start + bytes;
+		_high_water = std::max(_high_water, _offset);
+		return _block.get() + start;
+	}
+	++_overflows;
+	return _overflow.allocate(bytes, alignment);
+}
@@ -0,0 +1,112 @@
+#include "game.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+# include <immintrin.h>
+# define CFV_X86 1
+#endif
+
+// ============================================================================
+// COLLISION KERNELS : un cercle contre un tableau de cercles (SoA)
+// ============================================================================
+//
+// Test en distance au carré (pas de sqrt) : (dx² + dy²) < (r + ri)².
+// Les indices en collision sont écrits dans out dans l'ordre croissant
+// (out doit pouvoir contenir n entrées).
+
+size_t	circle_overlaps_scalar(float x, float y, float r, const float* xs, const float* ys,
+			const float* rs, size_t n, uint32_t* out) {
+	size_t count = 0;
+	for (size_t i = 0; i < n; ++i) {
+		float dx = xs[i] - x;
+		float dy = ys[i] - y;
+		float reach = rs[i] + r;
+		out[count] = (uint32_t)i;
+		count += (dx * dx + dy * dy < reach * reach);
+	}
+	return count;
+}
+
+#ifdef CFV_X86
+
+size_t	circle_overlaps_sse2(float x, float y, float r, const float* xs, const float* ys,
+			const float* rs, size_t n, uint32_t* out) {
+	const __m128 vx = _mm_set1_ps(x);
+	const __m128 vy = _mm_set1_ps(y);
+	const __m128 vr = _mm_set1_ps(r);
+	size_t count = 0;
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128 dx = _mm_sub_ps(_mm_loadu_ps(xs + i), vx);
+		__m128 dy = _mm_sub_ps(_mm_loadu_ps(ys + i), vy);
+		__m128 reach = _mm_add_ps(_mm_loadu_ps(rs + i), vr);
+		__m128 dist2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+		int mask = _mm_movemask_ps(_mm_cmplt_ps(dist2, _mm_mul_ps(reach, reach)));
+		while (mask) {
+			out[count++] = (uint32_t)(i + __builtin_ctz(mask));
+			mask &= mask - 1;
+		}
+	}
+	size_t tail = circle_overlaps_scalar(x, y, r, xs + i, ys + i, rs + i, n - i, out + count);
+	for (size_t k = 0; k < tail; ++k)
+		out[count + k] += (uint32_t)i;
+	return count + tail;
+}
+
+__attribute__((target("avx2")))
+size_t	circle_overlaps_avx2(float x, float y, float r, const float* xs, const float* ys,
+			const float* rs, size_t n, uint32_t* out) {
+	const __m256 vx = _mm256_set1_ps(x);
+	const __m256 vy = _mm256_set1_ps(y);
+	const __m256 vr = _mm256_set1_ps(r);
+	size_t count = 0;
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256 dx = _mm256_sub_ps(_mm256_loadu_ps(xs + i), vx);
+		__m256 dy = _mm256_sub_ps(_mm256_loadu_ps(ys + i), vy);
+		__m256 reach = _mm256_add_ps(_mm256_loadu_ps(rs + i), vr);
+		__m256 dist2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+		int mask = _mm256_movemask_ps(_mm256_cmp_ps(dist2, _mm256_mul_ps(reach, reach), _CMP_LT_OQ));
+		while (mask) {
+			out[count++] = (uint32_t)(i + __builtin_ctz(mask));
+			mask &= mask - 1;
+		}
+	}
+	size_t tail = circle_overlaps_sse2(x, y, r, xs + i, ys + i, rs + i, n - i, out + count);
+	for (size_t k = 0; k < tail; ++k)
+		out[count + k] += (uint32_t)i;
+	return count + tail;
+}
+
+#endif
+
+// Choix du kernel au premier appel selon le CPU
+static CircleOverlapFn	select_circle_overlaps() {
+#ifdef CFV_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return circle_overlaps_avx2;
+	return circle_overlaps_sse2;
+#else
+	return circle_overlaps_scalar;
+#endif
+}
+
+CircleOverlapFn	circle_overlaps_impl() {
+	static const CircleOverlapFn impl = select_circle_overlaps();
+	return impl;
+}
+
+const char*	circle_overlaps_name() {
+#ifdef CFV_X86
+	if (circle_overlaps_impl() == circle_overlaps_avx2)
+		return "avx2";
+	if (circle_overlaps_impl() == circle_overlaps_sse2)
+		return "sse2";
+#endif
+	return "scalar";
+}
+
+size_t	circle_overlaps(float x, float y, float r, const float* xs, const float* ys,
+			const float* rs, size_t n, uint32_t* out) {
+	return circle_overlaps_impl()(x, y, r, xs, ys, rs, n, out);
+}
@@ -0,0 +1,107 @@
+#include "game.h"
+
+// ============================================================================
+// FLOW FIELD
+// ============================================================================
+
+FlowField::FlowField()
+	:	_tiles(nullptr), _origin(0, 0), _width(0), _height(0), _tile_size(1),
+		_target(-1), _rebuilds(0) {}
+
+int		FlowField::tile_at(const Vector2f& pos) const {
+	int x = (int)std::floor((pos._x - _origin._x) / _tile_size);
+	int y = (int)std::floor((pos._y - _origin._y) / _tile_size);
+	if (x < 0 || y < 0 || x >= _width || y >= _height)
+		return -1;
+	return y * _width + x;
+}
+
+Vector2f	FlowField::tile_center(int index) const {
+	return _origin + Vector2f((index % _width + 0.5f) * _tile_size, (index / _width + 0.5f) * _tile_size);
+}
+
+// Reconstruit le champ si la cible a changé de tuile ou si la salle a changé.
+// Une cible sur un mur ou hors salle (franchissement de porte) garde l'ancien champ.
+bool	FlowField::update(const Room& room, const Vector2f& target) {
+	bool same_room = _tiles == &room.tiles() && _width == room._width && _height == room._height
+		&& _tile_size == room._tile_size && _origin._x == room._world_offset._x
+		&& _origin._y == room._world_offset._y;
+	if (!same_room) {
+		_tiles = &room.tiles();
+		_origin = room._world_offset;
+		_width = room._width;
+		_height = room._height;
+		_tile_size = std::max(room._tile_size, 1);
+		_target = -1;
+		_distance.assign(_width * _height, INT32_MAX);
+		_next.assign(_width * _height, -1);
+	}
+
+	int goal = tile_at(target);
+	if (goal < 0 || _tiles->get(goal % _width, goal / _width) == Room::WALL || goal == _target)
+		return false;
+	_target = goal;
+	_rebuilds++;
+
+	// BFS 4-connexe : distances en pas de tuile orthogonaux
+	static const int side_dx[4] = {-1, 1, 0, 0};
+	static const int side_dy[4] = {0, 0, -1, 1};
+	static const int diagonal_dx[4] = {-1, 1, -1, 1};
+	static const int diagonal_dy[4] = {-1, -1, 1, 1};
+	std::fill(_distance.begin(), _distance.end(), INT32_MAX);
+	_queue.clear();
+	_queue.push_back(goal);
+	_distance[goal] = 0;
+	for (size_t head = 0; head < _queue.size(); ++head) {
+		int i = _queue[head];
+		int x = i % _width;
+		int y = i / _width;
+		for (int k = 0; k < 4; ++k) {
+			int nx = x + side_dx[k];
+			int ny = y + side_dy[k];
+			if (nx < 0 || ny < 0 || nx >= _width || ny >= _height)
+				continue;
+			int n = ny * _width + nx;
+			if (_distance[n] != INT32_MAX || _tiles->get(nx, ny) == Room::WALL)
+				continue;
+			_distance[n] = _distance[i] + 1;
+			_queue.push_back(n);
+		}
+	}
+
+	// Chaque tuile atteinte vise la voisine la plus proche de la cible : côtés
+	// d'abord, puis diagonales (à distance strictement plus courte). Les
+	// diagonales lissent les trajets mais ne coupent pas les coins de mur.
+	for (int i : _queue) {
+		int x = i % _width;
+		int y = i / _width;
+		int best = -1;
+		int best_distance = _distance[i];
+		for (int k = 0; k < 4; ++k) {
+			int nx = x + side_dx[k];
+			int ny = y + side_dy[k];
+			if (nx < 0 || ny < 0 || nx >= _width || ny >= _height)
+				continue;
+			int n = ny * _width + nx;
+			if (_distance[n] >= best_distance)
+				continue;
+			best = n;
+			best_distance = _distance[n];
+		}
+		for (int k = 0; k < 4; ++k) {
+			int nx = x + diagonal_dx[k];
+			int ny = y + diagonal_dy[k];
+			if (nx < 0 || ny < 0 || nx >= _width || ny >= _height)
+				continue;
+			int n = ny * _width + nx;
+			if (_distance[n] >= best_distance)
+				continue;
+			if (_tiles->get(nx, y) == Room::WALL || _tiles->get(x, ny) == Room::WALL)
+				continue;
+			best = n;
+			best_distance = _distance[n];
+		}
+		_next[i] = best;
+	}
+	return true;
+}
@@ -0,0 +1,139 @@
+#include "game.h"
+
+// ============================================================================
+// JOB SYSTEM
+// ============================================================================
+
+JobSystem::JobSystem() : _pending(0), _batch(0), _stop(false) {
+	init(0);
+}
+
+JobSystem::~JobSystem() {
+	shutdown();
+}
+
+int		JobSystem::default_thread_count() {
+	int hw = (int)std::thread::hardware_concurrency();
+	return std::min(std::max(hw - 1, 0), 7);
+}
+
+// thread_count threads en plus du thread appelant (0 = tout sur le thread appelant)
+void	JobSystem::init(int thread_count) {
+	shutdown();
+	_stop = false;
+	_queues.clear();
+	for (int i = 0; i <= thread_count; ++i) {
+		_queues.emplace_back(new Queue());
+		_queues.back()->_jobs.resize(QUEUE_CAPACITY);
+	}
+	for (int i = 1; i <= thread_count; ++i)
+		_threads.emplace_back(&JobSystem::worker_loop, this, i);
+}
+
+void	JobSystem::shutdown() {
+	{
+		std::lock_guard<std::mutex> lock(_wake_lock);
+		_stop = true;
+	}
+	_wake.notify_all();
+	for (auto& t : _threads)
+		t.join();
+	_threads.clear();
+}
+
+void	JobSystem::run(size_t begin, size_t end, size_t grain,
+			void (*fn)(void*, size_t, size_t, int), void* ctx) {
+	if (begin >= end)
+		return;
+	grain = std::max(grain, (size_t)1);
+
+	// Pas de threads : exécution directe, mêmes morceaux que le chemin parallèle
+	if (_threads.empty()) {
+		for (size_t b = begin; b < end; b += grain)
+			fn(ctx, b, std::min(b + grain, end), 0);
+		return;
+	}
+
+	// Les files ont une capacité fixe : on grossit le grain si besoin
+	size_t workers = _queues.size();
+	size_t max_chunks = QUEUE_CAPACITY * workers;
+	size_t count = end - begin;
+	if ((count + grain - 1) / grain > max_chunks)
+		grain = (count + max_chunks - 1) / max_chunks;
+	size_t chunks = (count + grain - 1) / grain;
+
+	// Répartition round-robin, le vol de tâches rééquilibre ensuite
+	_pending.fetch_add((int)chunks, std::memory_order_relaxed);
+	for (size_t k = 0; k < chunks; ++k) {
+		Queue& q = *_queues[k % workers];
+		std::lock_guard<std::mutex> lock(q._lock);
+		Job& job = q._jobs[q._tail % QUEUE_CAPACITY];
+		job._fn = fn;
+		job._ctx = ctx;
+		job._begin = begin + k * grain;
+		job._end = std::min(job._begin + grain, end);
+		q._tail++;
+	}
+	{
+		std::lock_guard<std::mutex> lock(_wake_lock);
+		_batch++;
+	}
+	_wake.notify_all();
+
+	// Le thread appelant travaille aussi jusqu'à ce que tout soit terminé
+	Job job;
+	while (_pending.load(std::memory_order_acquire) > 0) {
+		if (pop(0, job) || steal(0, job))
+			execute(job, 0);
+		else
+			std::this_thread::yield();
+	}
+}
+
+// Le propriétaire dépile par la fin (dernier job poussé, encore chaud en cache)
+bool	JobSystem::pop(int worker, Job& out) {
+	Queue& q = *_queues[worker];
+	std::lock_guard<std::mutex> lock(q._lock);
+	if (q._head == q._tail)
+		return false;
+	q._tail--;
+	out = q._jobs[q._tail % QUEUE_CAPACITY];
+	return true;
+}
+
+// Les voleurs prennent par le début
+bool	JobSystem::steal(int thief, Job& out) {
+	int workers = worker_count();
+	for (int k = 1; k < workers; ++k) {
+		Queue& q = *_queues[(thief + k) % workers];
+		std::lock_guard<std::mutex> lock(q._lock);
+		if (q._head == q._tail)
+			continue;
+		out = q._jobs[q._head % QUEUE_CAPACITY];
+		q._head++;
+		return true;
+	}
+	return false;
+}
+
+void	JobSystem::execute(const Job& job, int worker) {
+	job._fn(job._ctx, job._begin, job._end, worker);
+	_pending.fetch_sub(1, std::memory_order_release);
+}
+
+void	JobSystem::worker_loop(int worker) {
+	uint64_t seen = 0;
+	Job job;
+	while (true) {
+		if (pop(worker, job) || steal(worker, job)) {
+			execute(job, worker);
+			continue;
+		}
+		// Plus rien à faire : on dort jusqu'au prochain parallel_for
+		std::unique_lock<std::mutex> lock(_wake_lock);
+		_wake.wait(lock, [&] { return _stop || _batch != seen; });
+		if (_stop)
+			return;
+		seen = _batch;
+	}
+}
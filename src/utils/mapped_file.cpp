@@ -0,0 +1,42 @@
+#include "game.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// ============================================================================
+// MAPPED FILE
+// ============================================================================
+
+MappedFile::MappedFile() : _data(nullptr), _size(0) {}
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+// Projection privée en lecture seule ; le descripteur peut être fermé tout de suite
+bool	MappedFile::open(const std::string& path) {
+	close();
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+		::close(fd);
+		return false;
+	}
+	void* data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (data == MAP_FAILED)
+		return false;
+	_data = (const uint8_t*)data;
+	_size = (size_t)st.st_size;
+	return true;
+}
+
+void	MappedFile::close() {
+	if (_data)
+		munmap((void*)_data, _size);
+	_data = nullptr;
+	_size = 0;
+}
@@ -0,0 +1,116 @@
+#include "game.h"
+
+// ============================================================================
+// PROFILER
+// ============================================================================
+
+const int	OVERLAY_REFRESH_FRAMES = 30;	// L'overlay recalcule ses percentiles toutes les N frames
+
+Profiler::Profiler() : _origin(std::chrono::steady_clock::now()), _overlay_age(OVERLAY_REFRESH_FRAMES) {}
+
+uint64_t	Profiler::now() const {
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - _origin).count();
+}
+
+// Anneau du thread appelant, enregistré à son premier appel (seul passage sous verrou)
+ProfileRing&	Profiler::ring() {
+	thread_local ProfileRing* local = nullptr;
+	if (!local) {
+		std::lock_guard<std::mutex> lock(_lock);
+		_rings.emplace_back(new ProfileRing((int)_rings.size()));
+		local = _rings.back().get();
+	}
+	return *local;
+}
+
+// Oublie les événements déjà enregistrés (les anneaux restent attribués)
+void	Profiler::clear() {
+	std::lock_guard<std::mutex> lock(_lock);
+	for (auto& ring : _rings)
+		ring->_written.store(0, std::memory_order_release);
+}
+
+// Appelle fn(event, thread) pour chaque événement encore présent dans les anneaux
+template <typename Fn>
+static void	for_each_event(const std::vector<std::unique_ptr<ProfileRing>>& rings, Fn fn) {
+	for (const auto& ring : rings) {
+		uint64_t written = ring->_written.load(std::memory_order_acquire);
+		uint64_t first = written > ProfileRing::CAPACITY ? written - ProfileRing::CAPACITY : 0;
+		for (uint64_t n = first; n < written; ++n)
+			fn(ring->_events[n & (ProfileRing::CAPACITY - 1)], ring->_thread);
+	}
+}
+
+static double	sorted_percentile(const std::vector<double>& sorted, double p) {
+	size_t idx = (size_t)(p * (sorted.size() - 1) + 0.5);
+	return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+// Zones regroupées par nom, dans l'ordre de première apparition
+void	Profiler::zone_stats(std::vector<ProfileZoneStats>& out) const {
+	std::vector<const char*> names;			// Chaînes littérales des zones
+	std::vector<std::vector<double>> durations;
+	std::unordered_map<std::string, size_t> zone_of;
+	for_each_event(_rings, [&](const ProfileEvent& e, int) {
+		auto it = zone_of.find(e._name);
+		if (it == zone_of.end()) {
+			it = zone_of.emplace(e._name, names.size()).first;
+			names.push_back(e._name);
+			durations.emplace_back();
+		}
+		durations[it->second].push_back((e._end - e._start) * 1e-3);
+	});
+
+	out.clear();
+	for (size_t z = 0; z < names.size(); ++z) {
+		std::vector<double>& d = durations[z];
+		std::sort(d.begin(), d.end());
+		out.push_back({names[z], d.size(), sorted_percentile(d, 0.50), sorted_percentile(d, 0.95),
+			sorted_percentile(d, 0.99)});
+	}
+}
+
+// Format trace_event de Chrome (chrome://tracing, Perfetto) : un événement
+// complet ("ph": "X") par zone, temps en µs
+bool	Profiler::dump_chrome_trace(const std::string& file) const {
+	std::ofstream out(file);
+	if (!out) {
+		printf("ERROR: Cannot write trace file %s\n", file.c_str());
+		return false;
+	}
+	out << "{\"traceEvents\":[\n";
+	size_t count = 0;
+	char line[256];
+	for_each_event(_rings, [&](const ProfileEvent& e, int thread) {
+		snprintf(line, sizeof(line), "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+			count ? ",\n" : "", e._name, thread, e._start * 1e-3, (e._end - e._start) * 1e-3);
+		out << line;
+		++count;
+	});
+	out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	printf("DEBUG: Wrote %zu profile events to %s\n", count, file.c_str());
+	return true;
+}
+
+void	Profiler::draw_overlay(int x, int y) {
+	if (++_overlay_age >= OVERLAY_REFRESH_FRAMES) {
+		zone_stats(_overlay_stats);
+		_overlay_age = 0;
+	}
+	int row = 18;
+	int height = row * ((int)_overlay_stats.size() + 1) + 10;
+	DrawRectangle(x, y, 430, height, {0, 0, 0, 170});
+	DrawText("zone                p50 / p95 / p99 (us)", x + 8, y + 5, 16, GOLD);
+	for (size_t z = 0; z < _overlay_stats.size(); ++z) {
+		const ProfileZoneStats& st = _overlay_stats[z];
+		DrawText(TextFormat("%-18s %8.1f %8.1f %8.1f", st._name, st._p50, st._p95, st._p99),
+			x + 8, y + 5 + row * (int)(z + 1), 16, WHITE);
+	}
+	render_stats()._draw_calls += 2 + (int)_overlay_stats.size();
+}
+
+Profiler&	profiler() {
+	static Profiler instance;
+	return instance;
+}
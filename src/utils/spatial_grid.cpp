@@ -0,0 +1,82 @@
+#include "game.h"
+
+// ============================================================================
+// SPATIAL GRID
+// ============================================================================
+
+SpatialGrid::SpatialGrid()
+	:	_origin(0, 0), _cell_size(64.0f), _inv_cell_size(1.0f / 64.0f),
+		_cols(1), _rows(1), _max_radius(0) {}
+
+int		SpatialGrid::cell_x(float x) const {
+	int cx = (int)std::floor((x - _origin._x) * _inv_cell_size);
+	return std::min(std::max(cx, 0), _cols - 1);
+}
+
+int		SpatialGrid::cell_y(float y) const {
+	int cy = (int)std::floor((y - _origin._y) * _inv_cell_size);
+	return std::min(std::max(cy, 0), _rows - 1);
+}
+
+// Capacité pour n entités : build ne réalloue plus tant qu'il y en a moins
+void	SpatialGrid::reserve(size_t n) {
+	_item_cell.reserve(n);
+	_items.reserve(n);
+	_xs.reserve(n);
+	_ys.reserve(n);
+	_rs.reserve(n);
+}
+
+void	SpatialGrid::build(const EntityStore& entities, const Room& room) {
+	// La grille couvre la salle, une cellule par tuile ; les entités hors salle
+	// sont rangées dans les cellules du bord
+	_origin = room._world_offset;
+	_cell_size = (float)std::max(room._tile_size, 1);
+	_inv_cell_size = 1.0f / _cell_size;
+	_cols = std::max(room._width, 1);
+	_rows = std::max(room._height, 1);
+	_max_radius = 0;
+
+	int cell_count = _cols * _rows;
+	_cell_start.assign(cell_count + 1, 0);
+	_item_cell.resize(entities.size());
+
+	// Comptage par cellule
+	int alive = 0;
+	for (size_t i = 0; i < entities.size(); ++i) {
+		if (!entities._alive[i]) {
+			_item_cell[i] = -1;
+			continue;
+		}
+		int cell = cell_y(entities._pos_y[i]) * _cols + cell_x(entities._pos_x[i]);
+		_item_cell[i] = cell;
+		_cell_start[cell + 1]++;
+		_max_radius = std::max(_max_radius, entities._radius[i]);
+		++alive;
+	}
+
+	// Préfixe : _cell_start[c] = premier slot de la cellule c
+	for (int c = 0; c < cell_count; ++c)
+		_cell_start[c + 1] += _cell_start[c];
+
+	// Remplissage stable (indices croissants dans chaque cellule)
+	_items.resize(alive);
+	_xs.resize(alive);
+	_ys.resize(alive);
+	_rs.resize(alive);
+	for (size_t i = 0; i < entities.size(); ++i) {
+		int cell = _item_cell[i];
+		if (cell < 0)
+			continue;
+		int slot = _cell_start[cell]++;
+		_items[slot] = (int)i;
+		_xs[slot] = entities._pos_x[i];
+		_ys[slot] = entities._pos_y[i];
+		_rs[slot] = entities._radius[i];
+	}
+
+	// Le remplissage a décalé chaque début d'une cellule : on restaure
+	for (int c = cell_count; c > 0; --c)
+		_cell_start[c] = _cell_start[c - 1];
+	_cell_start[0] = 0;
+}
@@ -0,0 +1,150 @@
+#include "game.h"
+
+// ============================================================================
+// SPRITE ATLAS
+// ============================================================================
+
+SpriteAtlas::SpriteAtlas() {
+	std::fill(_entity_first, _entity_first + ENTITY_ARCHETYPE_COUNT, -1);
+	std::fill(_entity_count, _entity_count + ENTITY_ARCHETYPE_COUNT, 0);
+}
+
+// Lit l'index en une fois et le valide, sans toucher au GPU (utilisable sans
+// fenêtre, par les outils)
+bool	SpriteAtlas::load_index(const std::string& file) {
+	std::ifstream in(file, std::ios::binary);
+	if (!in) {
+		printf("ERROR: Failed to load atlas file: %s\n", file.c_str());
+		return false;
+	}
+	std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+	AtlasFileHeader header;
+	if (data.size() < sizeof(header)) {
+		printf("ERROR: Failed to load atlas file: %s (truncated header)\n", file.c_str());
+		return false;
+	}
+	std::memcpy(&header, data.data(), sizeof(header));
+	if (std::memcmp(header._magic, ATLAS_MAGIC, 4) != 0 || header._version != ATLAS_VERSION) {
+		printf("ERROR: Failed to load atlas file: %s (bad magic or version)\n", file.c_str());
+		return false;
+	}
+	uint64_t pages_size = (uint64_t)header._page_count * sizeof(AtlasPage);
+	uint64_t frames_size = (uint64_t)header._frame_count * sizeof(AtlasFrame);
+	if (header._names_size == 0 || sizeof(header) + pages_size + frames_size + header._names_size != data.size()) {
+		printf("ERROR: Failed to load atlas file: %s (bad sizes)\n", file.c_str());
+		return false;
+	}
+
+	const char* cursor = data.data() + sizeof(header);
+	_pages.resize(header._page_count);
+	std::memcpy(_pages.data(), cursor, pages_size);
+	cursor += pages_size;
+	_frames.resize(header._frame_count);
+	std::memcpy(_frames.data(), cursor, frames_size);
+	cursor += frames_size;
+	_names.assign(cursor, cursor + header._names_size);
+	_names.back() = '\0';
+
+	for (const AtlasFrame& f : _frames) {
+		if (f._page >= _pages.size() || f._name >= _names.size()
+			|| f._x + f._width > _pages[f._page]._width || f._y + f._height > _pages[f._page]._height) {
+			printf("ERROR: Failed to load atlas file: %s (bad frame)\n", file.c_str());
+			_frames.clear();
+			return false;
+		}
+	}
+	_file = file;
+	return true;
+}
+
+// Index puis une texture par page ; à appeler après InitWindow
+bool	SpriteAtlas::load(const std::string& file) {
+	unload();
+	if (!load_index(file))
+		return false;
+	for (size_t p = 0; p < _pages.size(); ++p) {
+		Image image = LoadImage(page_file((int)p).c_str());
+		if (!image.data || image.width != _pages[p]._width || image.height != _pages[p]._height) {
+			printf("ERROR: Failed to load atlas page: %s\n", page_file((int)p).c_str());
+			UnloadImage(image);
+			unload();
+			return false;
+		}
+		Texture2D texture = LoadTextureFromImage(image);
+		UnloadImage(image);
+		SetTextureFilter(texture, TEXTURE_FILTER_POINT);
+		_textures.push_back(texture);
+	}
+	// Une fois pour toutes : draw n'a plus qu'à indexer
+	for (int a = 0; a < ENTITY_ARCHETYPE_COUNT; ++a) {
+		const char* sprite = archetypes().entity(a)._sprite;
+		_entity_first[a] = sprite ? animation(sprite, _entity_count[a]) : -1;
+	}
+	printf("DEBUG: Loaded atlas %s (%zu frames, %zu pages)\n", file.c_str(), _frames.size(), _pages.size());
+	return true;
+}
+
+// À appeler avant CloseWindow : les textures vivent dans le contexte GPU
+void	SpriteAtlas::unload() {
+	for (Texture2D& texture : _textures)
+		UnloadTexture(texture);
+	_textures.clear();
+	std::fill(_entity_first, _entity_first + ENTITY_ARCHETYPE_COUNT, -1);
+	std::fill(_entity_count, _entity_count + ENTITY_ARCHETYPE_COUNT, 0);
+}
+
+// data/sprites.atlas -> data/sprites_<page>.png
+std::string	SpriteAtlas::page_file(int page) const {
+	size_t dot = _file.rfind('.');
+	size_t slash = _file.rfind('/');
+	bool extension = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+	return _file.substr(0, extension ? dot : _file.length()) + "_" + std::to_string(page) + ".png";
+}
+
+static bool	frame_less(const SpriteAtlas& atlas, const AtlasFrame& frame, const char* name) {
+	return std::strcmp(&atlas._names[frame._name], name) < 0;
+}
+
+// Indice de la frame nommée name (chemin relatif sans .png), -1 si absente
+int		SpriteAtlas::find(const std::string& name) const {
+	auto it = std::lower_bound(_frames.begin(), _frames.end(), name.c_str(),
+		[&](const AtlasFrame& f, const char* n) { return frame_less(*this, f, n); });
+	if (it == _frames.end() || name != &_names[it->_name])
+		return -1;
+	return (int)(it - _frames.begin());
+}
+
+// Première frame dont le nom commence par prefix, et leur nombre (0 si aucune)
+int		SpriteAtlas::animation(const char* prefix, int& count) const {
+	auto first = std::lower_bound(_frames.begin(), _frames.end(), prefix,
+		[&](const AtlasFrame& f, const char* n) { return frame_less(*this, f, n); });
+	size_t length = std::strlen(prefix);
+	auto last = first;
+	while (last != _frames.end() && std::strncmp(&_names[last->_name], prefix, length) == 0)
+		++last;
+	count = (int)(last - first);
+	return count ? (int)(first - _frames.begin()) : -1;
+}
+
+// Dessine la frame, centre de l'image d'origine en center. Les frames d'une
+// même page s'enchaînent dans le même lot raylib : seuls les changements de
+// page sont comptés.
+void	SpriteAtlas::draw(int frame, const Vector2f& center, float scale, Color tint) const {
+	const AtlasFrame& f = _frames[frame];
+	Rectangle source = {(float)f._x, (float)f._y, (float)f._width, (float)f._height};
+	Rectangle dest = {center._x + (f._trim_x - f._source_width * 0.5f) * scale,
+		center._y + (f._trim_y - f._source_height * 0.5f) * scale, f._width * scale, f._height * scale};
+	DrawTexturePro(_textures[f._page], source, dest, {0, 0}, 0, tint);
+	RenderStats& stats = render_stats();
+	stats._draw_calls++;
+	if (stats._atlas_page != f._page + 1) {
+		stats._texture_switches++;
+		stats._atlas_page = f._page + 1;
+	}
+}
+
+SpriteAtlas&	sprite_atlas() {
+	static SpriteAtlas instance;
+	return instance;
+}
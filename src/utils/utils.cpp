@@ -4,16 +4,23 @@
 // UTILITY
 // ============================================================================
 
+// Comparaison en distance au carré : pas de sqrt
 bool	aabb_collision(Vector2f p1, float r1, Vector2f p2, float r2) {
 	float dx = p1._x - p2._x;
 	float dy = p1._y - p2._y;
-	float dist = std::sqrt(dx * dx + dy * dy);
-	return dist < (r1 + r2);
+	float reach = r1 + r2;
+	return dx * dx + dy * dy < reach * reach;
 }
 
 void	resolve_collision(Vector2f& p1, float r1, Vector2f& p2, float r2) {
 	Vector2f diff = p1 - p2;
-	float dist = diff.length();
+	float dist2 = diff._x * diff._x + diff._y * diff._y;
+	float reach = r1 + r2;
+	
+	// Pas de chevauchement : rien à faire (et pas de sqrt)
+	if (dist2 >= reach * reach)
+		return;
+	float dist = std::sqrt(dist2);
 	
 	// Éviter la division par zéro
 	if (dist == 0) {
@@ -28,8 +35,8 @@ void	resolve_collision(Vector2f& p1, float r1, Vector2f& p2, float r2) {
 	float overlap = (r1 + r2) - dist;
 	
 	if (overlap > 0) {
-		// Normaliser la direction et déplacer les deux entités
-		Vector2f direction = diff.normalized();
+		// Normaliser la direction (dist est déjà connue) et déplacer les deux entités
+		Vector2f direction = diff * (1.0f / dist);
 		
 		// Déplacer chaque entité de la moitié du chevauchement
 		Vector2f correction = direction * (overlap * 0.5f);
@@ -38,9 +45,119 @@ void	resolve_collision(Vector2f& p1, float r1, Vector2f& p2, float r2) {
 	}
 }
 
-int random_int(int min, int max)
+// Cercle de rayon r allant de a à b contre un cercle fixe : premier t ∈ [0, 1]
+// où les deux se chevauchent (0 s'ils se chevauchent déjà au départ)
+bool	sweep_circle_circle(const Vector2f& a, const Vector2f& b, float r,
+			const Vector2f& center, float center_r, float& t_hit) {
+	Vector2f m = a - center;
+	float reach = r + center_r;
+	float c = m._x * m._x + m._y * m._y - reach * reach;
+	if (c < 0) {
+		t_hit = 0;
+		return true;
+	}
+	Vector2f d = b - a;
+	float len2 = d._x * d._x + d._y * d._y;
+	float half_b = m._x * d._x + m._y * d._y;
+	// Immobile ou s'éloigne : pas de contact
+	if (len2 == 0 || half_b >= 0)
+		return false;
+	float disc = half_b * half_b - len2 * c;
+	if (disc < 0)
+		return false;
+	float t = (-half_b - std::sqrt(disc)) / len2;
+	if (t > 1)
+		return false;
+	t_hit = t;
+	return true;
+}
+
+// Réduit [t0, t1] à la partie du segment comprise entre lo et hi sur un axe
+static bool	clip_slab(float start, float dir, float lo, float hi, float& t0, float& t1) {
+	// Bornes strictes : effleurer la boîte élargie n'est pas un contact
+	if (dir == 0)
+		return start > lo && start < hi;
+	float ta = (lo - start) / dir;
+	float tb = (hi - start) / dir;
+	if (ta > tb)
+		std::swap(ta, tb);
+	t0 = std::max(t0, ta);
+	t1 = std::min(t1, tb);
+	return t0 < t1;
+}
+
+// Cercle de rayon r allant de a à b contre la boîte [lo, hi] : on entre dans la
+// boîte élargie de r ; si le point d'entrée est en face d'un côté c'est le
+// contact, sinon il faut encore toucher le cercle de rayon r du coin.
+bool	sweep_circle_box(const Vector2f& a, const Vector2f& b, float r,
+			const Vector2f& lo, const Vector2f& hi, float& t_hit) {
+	float ex = std::max(std::max(lo._x - a._x, a._x - hi._x), 0.0f);
+	float ey = std::max(std::max(lo._y - a._y, a._y - hi._y), 0.0f);
+	if (ex * ex + ey * ey < r * r) {
+		t_hit = 0;
+		return true;
+	}
+	Vector2f d = b - a;
+	float t0 = 0;
+	float t1 = 1;
+	if (!clip_slab(a._x, d._x, lo._x - r, hi._x + r, t0, t1)
+		|| !clip_slab(a._y, d._y, lo._y - r, hi._y + r, t0, t1))
+		return false;
+	Vector2f p = a + d * t0;
+	if ((p._x >= lo._x && p._x <= hi._x) || (p._y >= lo._y && p._y <= hi._y)) {
+		t_hit = t0;
+		return true;
+	}
+	Vector2f corner(p._x < lo._x ? lo._x : hi._x, p._y < lo._y ? lo._y : hi._y);
+	return sweep_circle_circle(a, b, r, corner, 0, t_hit);
+}
+
+Vector2f	lerp(const Vector2f& a, const Vector2f& b, float t) {
+	return a + (b - a) * t;
+}
+
+// Rectangle du monde visible à l'écran à travers la caméra (sans rotation)
+Rectangle	camera_view(const Camera2D& camera) {
+	float inv_zoom = 1.0f / camera.zoom;
+	return {camera.target.x - camera.offset.x * inv_zoom, camera.target.y - camera.offset.y * inv_zoom,
+		SCREEN_WIDTH * inv_zoom, SCREEN_HEIGHT * inv_zoom};
+}
+
+bool	circle_in_rect(const Vector2f& center, float radius, const Rectangle& rect) {
+	return center._x + radius >= rect.x && center._x - radius <= rect.x + rect.width
+		&& center._y + radius >= rect.y && center._y - radius <= rect.y + rect.height;
+}
+
+// FNV-1a 64 bits, chaînable : passer le résultat précédent comme hash
+uint64_t	hash_bytes(const void* data, size_t size, uint64_t hash) {
+	const uint8_t* bytes = (const uint8_t*)data;
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+static std::mt19937&	random_engine()
 {
     static std::mt19937 gen(std::random_device{}());
+    return gen;
+}
+
+int random_int(int min, int max)
+{
     std::uniform_int_distribution<int> distrib(min, max);
-    return distrib(gen);
+    return distrib(random_engine());
+}
+
+// Graine fixe pour les scénarios reproductibles (bench headless)
+void random_seed(unsigned int seed)
+{
+    random_engine().seed(seed);
+}
+
+RenderStats&	render_stats()
+{
+    static RenderStats stats = {0, 0, 0, 0};
+    return stats;
 }
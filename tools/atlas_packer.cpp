@@ -0,0 +1,333 @@
+#include "game.h"
+#include <chrono>
+#include <cstdlib>
+
+// ============================================================================
+// ATLAS PACKER : PNG d'un dossier -> pages d'atlas + index binaire (.atlas)
+// ============================================================================
+//
+// Usage : atlas_packer OUT.atlas DIR [--page N] [--padding N]
+// Parcourt DIR récursivement, rogne les bords transparents de chaque PNG et
+// les range par étagères (hauteurs décroissantes) dans des pages d'au plus
+// N x N pixels. Écrit OUT_<n>.png par page et l'index OUT.atlas (frames
+// nommées par leur chemin relatif sans .png), puis relit l'index pour
+// vérifier chaque frame. Uniquement du travail CPU : pas de fenêtre.
+
+struct PackedImage {
+	std::string				_name;			// Chemin relatif à DIR, sans .png
+	int						_source_width;
+	int						_source_height;
+	int						_trim_x;
+	int						_trim_y;
+	int						_width;
+	int						_height;
+	std::vector<uint8_t>	_pixels;		// RGBA rogné, ligne par ligne
+	int						_page;
+	int						_x;
+	int						_y;
+};
+
+// Étagère d'une page : bande de hauteur fixe remplie de gauche à droite
+struct Shelf {
+	int		_page;
+	int		_y;
+	int		_height;
+	int		_x;
+};
+
+static double	elapsed_ms(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void	list_png(const std::string& dir, const std::string& prefix, std::vector<std::string>& out) {
+	DIR* handle = opendir(dir.c_str());
+	if (!handle) {
+		printf("WARNING: Could not open directory: %s\n", dir.c_str());
+		return;
+	}
+	struct dirent* entry;
+	while ((entry = readdir(handle)) != nullptr) {
+		std::string name = entry->d_name;
+		if (name == "." || name == "..")
+			continue;
+		std::string path = dir + "/" + name;
+		DIR* sub = opendir(path.c_str());
+		if (sub) {
+			closedir(sub);
+			list_png(path, prefix + name + "/", out);
+		} else if (name.length() > 4 && name.compare(name.length() - 4, 4, ".png") == 0) {
+			out.push_back(prefix + name);
+		}
+	}
+	closedir(handle);
+}
+
+// Charge en RGBA 8 bits et rogne les bords transparents (une image vide
+// garde un pixel transparent)
+static bool	load_trimmed(const std::string& dir, const std::string& file, PackedImage& out) {
+	Image image = LoadImage((dir + "/" + file).c_str());
+	if (!image.data) {
+		printf("ERROR: Failed to load image: %s/%s\n", dir.c_str(), file.c_str());
+		return false;
+	}
+	if (image.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8)
+		ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+	const uint8_t* pixels = (const uint8_t*)image.data;
+	int x0 = image.width, y0 = image.height, x1 = -1, y1 = -1;
+	for (int y = 0; y < image.height; ++y) {
+		for (int x = 0; x < image.width; ++x) {
+			if (pixels[((size_t)y * image.width + x) * 4 + 3] == 0)
+				continue;
+			x0 = std::min(x0, x);
+			y0 = std::min(y0, y);
+			x1 = std::max(x1, x);
+			y1 = std::max(y1, y);
+		}
+	}
+	if (x1 < 0) {
+		x0 = y0 = x1 = y1 = 0;
+	}
+
+	out._name = file.substr(0, file.length() - 4);
+	out._source_width = image.width;
+	out._source_height = image.height;
+	out._trim_x = x0;
+	out._trim_y = y0;
+	out._width = x1 - x0 + 1;
+	out._height = y1 - y0 + 1;
+	out._pixels.resize((size_t)out._width * out._height * 4);
+	for (int y = 0; y < out._height; ++y)
+		std::memcpy(&out._pixels[(size_t)y * out._width * 4], pixels + ((size_t)(y0 + y) * image.width + x0) * 4,
+			(size_t)out._width * 4);
+	UnloadImage(image);
+	return true;
+}
+
+// Rangement par étagères : images triées par hauteur décroissante, chacune
+// dans la première étagère assez haute et assez large, sinon une nouvelle
+// étagère, sinon une nouvelle page de width x height. Renvoie le nombre de
+// pixels des pages produites.
+static size_t	pack(std::vector<PackedImage*>& images, int width, int height, int padding, std::vector<AtlasPage>& pages) {
+	std::sort(images.begin(), images.end(), [](const PackedImage* a, const PackedImage* b) {
+		if (a->_height != b->_height)
+			return a->_height > b->_height;
+		if (a->_width != b->_width)
+			return a->_width > b->_width;
+		return a->_name < b->_name;
+	});
+	std::vector<Shelf> shelves;
+	std::vector<int> page_bottom;			// Prochaine étagère libre de chaque page
+	for (PackedImage* image : images) {
+		int w = image->_width + padding;
+		int h = image->_height + padding;
+		Shelf* shelf = nullptr;
+		for (Shelf& s : shelves) {
+			if (s._height >= h && s._x + w <= width) {
+				shelf = &s;
+				break;
+			}
+		}
+		if (!shelf) {
+			int page = 0;
+			while (page < (int)page_bottom.size() && page_bottom[page] + h > height)
+				++page;
+			if (page == (int)page_bottom.size()) {
+				page_bottom.push_back(padding);
+				pages.push_back({0, 0});
+			}
+			shelves.push_back({page, page_bottom[page], h, padding});
+			page_bottom[page] += h;
+			shelf = &shelves.back();
+		}
+		image->_page = shelf->_page;
+		image->_x = shelf->_x;
+		image->_y = shelf->_y;
+		shelf->_x += w;
+		AtlasPage& page = pages[shelf->_page];
+		page._width = (uint16_t)std::max<int>(page._width, image->_x + image->_width);
+		page._height = (uint16_t)std::max<int>(page._height, image->_y + image->_height);
+	}
+	size_t pixels = 0;
+	for (const AtlasPage& page : pages)
+		pixels += (size_t)page._width * page._height;
+	return pixels;
+}
+
+static bool	write_pages(const std::vector<PackedImage>& images, const std::vector<AtlasPage>& pages,
+				const SpriteAtlas& names) {
+	for (size_t p = 0; p < pages.size(); ++p) {
+		Image page = GenImageColor(pages[p]._width, pages[p]._height, BLANK);
+		uint8_t* pixels = (uint8_t*)page.data;
+		for (const PackedImage& image : images) {
+			if (image._page != (int)p)
+				continue;
+			for (int y = 0; y < image._height; ++y)
+				std::memcpy(pixels + ((size_t)(image._y + y) * pages[p]._width + image._x) * 4,
+					&image._pixels[(size_t)y * image._width * 4], (size_t)image._width * 4);
+		}
+		bool ok = ExportImage(page, names.page_file((int)p).c_str());
+		UnloadImage(page);
+		if (!ok) {
+			printf("ERROR: Failed to write atlas page: %s\n", names.page_file((int)p).c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
+// Frames dans l'ordre des noms (celui de images)
+static bool	write_index(const std::string& file, const std::vector<PackedImage>& images,
+				const std::vector<AtlasPage>& pages) {
+	std::vector<AtlasFrame> frames;
+	std::string names;
+	for (const PackedImage& image : images) {
+		AtlasFrame frame;
+		frame._name = (uint32_t)names.size();
+		frame._page = (uint16_t)image._page;
+		frame._x = (uint16_t)image._x;
+		frame._y = (uint16_t)image._y;
+		frame._width = (uint16_t)image._width;
+		frame._height = (uint16_t)image._height;
+		frame._trim_x = (uint16_t)image._trim_x;
+		frame._trim_y = (uint16_t)image._trim_y;
+		frame._source_width = (uint16_t)image._source_width;
+		frame._source_height = (uint16_t)image._source_height;
+		frame._reserved = 0;
+		frames.push_back(frame);
+		names += image._name;
+		names += '\0';
+	}
+
+	AtlasFileHeader header;
+	std::memcpy(header._magic, ATLAS_MAGIC, 4);
+	header._version = ATLAS_VERSION;
+	header._flags = 0;
+	header._page_count = (uint32_t)pages.size();
+	header._frame_count = (uint32_t)frames.size();
+	header._names_size = (uint32_t)names.size();
+	header._reserved = 0;
+
+	std::ofstream out(file, std::ios::binary | std::ios::trunc);
+	if (!out.is_open()) {
+		printf("ERROR: Failed to write atlas file: %s\n", file.c_str());
+		return false;
+	}
+	out.write((const char*)&header, sizeof(header));
+	out.write((const char*)pages.data(), (std::streamsize)(pages.size() * sizeof(AtlasPage)));
+	out.write((const char*)frames.data(), (std::streamsize)(frames.size() * sizeof(AtlasFrame)));
+	out.write(names.data(), (std::streamsize)names.size());
+	return out.good();
+}
+
+int main(int argc, char** argv) {
+	if (argc < 3) {
+		printf("Usage: %s OUT.atlas DIR [--page N] [--padding N]\n", argv[0]);
+		return 1;
+	}
+	std::string out_file = argv[1];
+	std::string dir = argv[2];
+	int page_size = ATLAS_PAGE_SIZE;
+	int padding = 1;
+	for (int i = 3; i + 1 < argc; i += 2) {
+		std::string arg = argv[i];
+		if (arg == "--page") page_size = std::min(std::max(std::atoi(argv[i + 1]), 16), (int)UINT16_MAX);
+		else if (arg == "--padding") padding = std::max(std::atoi(argv[i + 1]), 0);
+		else {
+			printf("ERROR: Unknown argument: %s\n", arg.c_str());
+			return 1;
+		}
+	}
+	while (!dir.empty() && dir.back() == '/')
+		dir.pop_back();
+
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point start = Clock::now();
+	std::vector<std::string> files;
+	list_png(dir, "", files);
+	// readdir n'a pas d'ordre garanti : trié pour un atlas reproductible. Le
+	// tri se fait sur le nom de frame, sans .png, comme le lower_bound de
+	// SpriteAtlas::find ('foo-1' < 'foo' alors que 'foo-1.png' > 'foo.png')
+	std::sort(files.begin(), files.end(), [](const std::string& a, const std::string& b) {
+		return a.compare(0, a.length() - 4, b, 0, b.length() - 4) < 0;
+	});
+
+	std::vector<PackedImage> images;
+	size_t source_pixels = 0;
+	int failed = 0;
+	for (const std::string& file : files) {
+		PackedImage image;
+		if (!load_trimmed(dir, file, image)) {
+			failed++;
+			continue;
+		}
+		if (image._width + 2 * padding > page_size || image._height + 2 * padding > page_size) {
+			printf("WARNING: %s (%dx%d) does not fit in a %d page, skipped\n", file.c_str(),
+				image._width, image._height, page_size);
+			failed++;
+			continue;
+		}
+		source_pixels += (size_t)image._source_width * image._source_height;
+		images.push_back(std::move(image));
+	}
+	if (images.empty()) {
+		printf("ERROR: No image to pack in %s\n", dir.c_str());
+		return 1;
+	}
+	double load_ms = elapsed_ms(start);
+
+	start = Clock::now();
+	std::vector<PackedImage*> order;
+	for (PackedImage& image : images)
+		order.push_back(&image);
+	// Des étagères sur toute la largeur laissent beaucoup de vide sous les
+	// images basses : on essaie aussi des largeurs moitié, quart... et on garde
+	// le moins de pages, puis le moins de pixels
+	int max_width = 0;
+	for (const PackedImage& image : images)
+		max_width = std::max(max_width, image._width + 2 * padding);
+	std::vector<AtlasPage> pages;
+	size_t best_pixels = pack(order, page_size, page_size, padding, pages);
+	int best_width = page_size;
+	for (int width = page_size / 2; width >= max_width; width /= 2) {
+		std::vector<AtlasPage> candidate;
+		size_t pixels = pack(order, width, page_size, padding, candidate);
+		if (candidate.size() < pages.size() || (candidate.size() == pages.size() && pixels < best_pixels)) {
+			best_pixels = pixels;
+			best_width = width;
+		}
+	}
+	pages.clear();
+	pack(order, best_width, page_size, padding, pages);
+	double pack_ms = elapsed_ms(start);
+
+	SpriteAtlas atlas;
+	atlas._file = out_file;
+	if (!write_pages(images, pages, atlas) || !write_index(out_file, images, pages))
+		return 1;
+
+	// Relecture : chaque image doit se retrouver par son nom, au même endroit
+	if (!atlas.load_index(out_file) || atlas._frames.size() != images.size())
+		return 1;
+	for (size_t i = 0; i < images.size(); ++i) {
+		int frame = atlas.find(images[i]._name);
+		if (frame != (int)i || atlas._frames[frame]._x != images[i]._x || atlas._frames[frame]._y != images[i]._y) {
+			printf("ERROR: %s: frame %s mismatch after pack\n", out_file.c_str(), images[i]._name.c_str());
+			return 1;
+		}
+	}
+
+	size_t packed_pixels = 0;
+	size_t trimmed_pixels = 0;
+	for (const AtlasPage& page : pages)
+		packed_pixels += (size_t)page._width * page._height;
+	for (const PackedImage& image : images)
+		trimmed_pixels += (size_t)image._width * image._height;
+	printf("atlas-packer: %zu images -> %zu pages, %d failed\n", images.size(), pages.size(), failed);
+	for (size_t p = 0; p < pages.size(); ++p)
+		printf("  page %zu: %dx%d (%s)\n", p, pages[p]._width, pages[p]._height, atlas.page_file((int)p).c_str());
+	printf("  pixels: %zu source, %zu trimmed, %zu in pages (%.0f%% filled)\n", source_pixels, trimmed_pixels,
+		packed_pixels, 100.0 * trimmed_pixels / packed_pixels);
+	printf("  file reads at startup: %zu -> %zu (index + pages)\n", images.size(), pages.size() + 1);
+	printf("  load %.1f ms, pack %.2f ms\n", load_ms, pack_ms);
+	return failed ? 1 : 0;
+}
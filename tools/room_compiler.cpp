@@ -0,0 +1,67 @@
+#include "game.h"
+#include <chrono>
+
+// ============================================================================
+// ROOM COMPILER : .room (texte) -> .roomb (binaire projeté en mémoire)
+// ============================================================================
+//
+// Usage : room_compiler FILE.room [FILE.room ...]
+// Écrit FILE.roomb à côté de chaque source, relit le résultat pour vérifier
+// chaque tuile et compare le temps de chargement texte / binaire, et la
+// mémoire des tuiles en chunks face à une grille d'un octet par tuile.
+
+static double	elapsed_us(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool	compile_room(const std::string& source) {
+	typedef std::chrono::steady_clock Clock;
+	std::string target = source + "b";
+
+	RoomTemplate text;
+	Clock::time_point start = Clock::now();
+	if (!text.load_text(source))
+		return false;
+	double text_us = elapsed_us(start);
+
+	if (!text.save_binary(target, "source=" + source + "\n"))
+		return false;
+
+	RoomTemplate binary;
+	start = Clock::now();
+	if (!binary.load_binary(target))
+		return false;
+	double binary_us = elapsed_us(start);
+
+	if (binary._width != text._width || binary._height != text._height) {
+		printf("ERROR: %s: size mismatch after compile\n", target.c_str());
+		return false;
+	}
+	for (int y = 0; y < text._height; ++y) {
+		for (int x = 0; x < text._width; ++x) {
+			if (binary.get_tile(x, y) != text.get_tile(x, y)) {
+				printf("ERROR: %s: tile (%d, %d) mismatch after compile\n", target.c_str(), x, y);
+				return false;
+			}
+		}
+	}
+	const TileChunks& tiles = binary._tiles;
+	printf("  %-32s %3dx%-3d | text %8.1f us | mmap %6.1f us | tiles %7zu B (flat %7zu B, %zu/%zu chunks detailed)\n",
+		target.c_str(), text._width, text._height, text_us, binary_us, tiles.memory_bytes(),
+		(size_t)text._width * text._height, tiles._block_count, tiles.chunk_count());
+	return true;
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		printf("Usage: %s FILE.room [FILE.room ...]\n", argv[0]);
+		return 1;
+	}
+	int failed = 0;
+	for (int i = 1; i < argc; ++i) {
+		if (!compile_room(argv[i]))
+			failed++;
+	}
+	printf("room-compiler: %d compiled, %d failed\n", argc - 1 - failed, failed);
+	return failed ? 1 : 0;
+}